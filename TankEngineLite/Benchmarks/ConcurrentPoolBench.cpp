@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////
+// ConcurrentPoolBench.cpp: Stress test for ConcurrentPool, every thread gets and pops objects
+//		as fast as it can while the others do the same. A side table of claims catches a slot
+//		handed out twice, the pool has to be empty again at the end. Reports the throughput
+//		for 1 thread up to every core, run it under ThreadSanitizer with make tsan
+//////////////////////////////////////////////////////////////////////////
+
+// DEBUG_POOL pulls the memory tracker in to Pool.h. POOL_NO_THROW leaves out the MSVC only std::exception(const char*),
+//  no thread holds more than its share of the pool
+#define DEBUG_POOL
+#define POOL_NO_THROW
+#include "Pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+constexpr uint32_t POOL_SIZE = 4096U;
+constexpr uint32_t OPS = 1U << 21U;
+
+using BenchPool = ConcurrentPool<int, POOL_SIZE>;
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    Hammer
+// FullName:  Hammer
+// Access:    public
+// Returns:   double
+// Description: threadCount threads share OPS gets and pops, each holding at most half its share of the pool.
+//		Clears isOk when a slot gets claimed twice or popped while free. Returns operations per second
+// Parameter: BenchPool & pool
+// Parameter: uint32_t threadCount
+// Parameter: std::atomic<bool> & isOk
+double Hammer(BenchPool& pool, uint32_t threadCount, std::atomic<bool>& isOk)
+{
+	std::vector<std::atomic<uint8_t>> claims(POOL_SIZE);
+	for (auto& claim : claims)
+		claim.store(0U);
+
+	const uint32_t hold = std::max(POOL_SIZE / threadCount / 2U, 1U);
+	const uint32_t opsPerThread = OPS / threadCount;
+
+	std::atomic<uint32_t> ready{ 0U };
+	std::atomic<bool> go{ false };
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0U; t < threadCount; ++t)
+	{
+		threads.emplace_back([&, t]()
+			{
+				std::mt19937 random(t);
+				std::vector<int*> held;
+				held.reserve(hold);
+
+				auto claim = [&](int* pObject)
+				{
+					if (claims[pObject - pool.GetPool()].exchange(1U) != 0U)
+						isOk = false;
+				};
+
+				auto release = [&](int* pObject)
+				{
+					if (claims[pObject - pool.GetPool()].exchange(0U) != 1U)
+						isOk = false;
+
+					pool.Pop(pObject);
+				};
+
+				++ready;
+				while (!go)
+					std::this_thread::yield();
+
+				for (uint32_t op = 0U; op < opsPerThread; ++op)
+				{
+					// Grow to the hold limit then mix, about two gets for every pop
+					if (held.size() < hold && (held.empty() || random() % 3U != 0U))
+					{
+						int* pObject = pool.Get();
+						claim(pObject);
+						*pObject = static_cast<int>(t);
+						held.push_back(pObject);
+					}
+					else
+					{
+						const uint32_t pick = random() % static_cast<uint32_t>(held.size());
+
+						if (*held[pick] != static_cast<int>(t))
+							isOk = false;
+
+						release(held[pick]);
+						held[pick] = held.back();
+						held.pop_back();
+					}
+				}
+
+				for (auto pObject : held)
+					release(pObject);
+			});
+	}
+
+	while (ready < threadCount)
+		std::this_thread::yield();
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	go = true;
+
+	for (auto& thread : threads)
+		thread.join();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return static_cast<double>(opsPerThread * threadCount) / seconds;
+}
+
+int main()
+{
+	const uint32_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+
+	std::vector<uint32_t> threadCounts{ 1U, 2U, 4U, 8U };
+	if (cores > 8U)
+		threadCounts.push_back(cores);
+
+	std::atomic<bool> isOk{ true };
+	std::printf("ConcurrentPool<int, %u>, %u gets and pops per run, %u cores\n", POOL_SIZE, OPS, cores);
+
+	for (const uint32_t threadCount : threadCounts)
+	{
+		auto pPool = std::make_unique<BenchPool>();
+		const double opsPerSecond = Hammer(*pPool, threadCount, isOk);
+
+		uint32_t left = 0U;
+		pPool->ForAllActive([&left](int*) { ++left; });
+
+		if (pPool->GetActiveCount() != 0U || left != 0U)
+			isOk = false;
+
+		std::printf("%2u threads: %6.1f M ops/s, active at the end %u\n", threadCount, opsPerSecond / 1e6, pPool->GetActiveCount());
+	}
+
+	std::printf(isOk ? "No slot claimed twice\n" : "FAILED, a slot got claimed twice or the pool didn't empty\n");
+	return isOk ? 0 : 1;
+}
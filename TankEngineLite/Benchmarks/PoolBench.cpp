@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////
+// PoolBench.cpp: Alloc/free latency of Pool and PagedPool at 10%, 50% and 99% occupancy.
+//		Every measured step frees a random live object and allocates one back, so the
+//		occupancy stays put while the free slots end up scattered over the whole pool
+//////////////////////////////////////////////////////////////////////////
+
+// DEBUG_POOL pulls the memory tracker in to Pool.h. POOL_NO_THROW leaves out the MSVC only std::exception(const char*),
+//  the bench never fills a pool or pops an object that isn't in it
+#define DEBUG_POOL
+#define POOL_NO_THROW
+#include "Pool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+// About the size of a small component
+struct BenchObject
+{
+	float data[8];
+};
+
+constexpr uint32_t POOL_SIZE = 4096U;
+constexpr uint32_t PAGE_SIZE = 256U;
+constexpr uint32_t STEPS = 1U << 20U;
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    MeasurePairs
+// FullName:  MeasurePairs<typename P>
+// Access:    public
+// Returns:   double
+// Description: Fill pool up to live objects, then time STEPS pairs of one random pop and one get.
+//		Returns nanoseconds per pair
+// Parameter: P & pool
+// Parameter: uint32_t live
+template<typename P>
+double MeasurePairs(P& pool, uint32_t live)
+{
+	std::mt19937 random(live);
+	std::vector<BenchObject*> objects;
+	objects.reserve(live);
+
+	for (uint32_t i = 0U; i < live; ++i)
+		objects.push_back(pool.Get());
+
+	// Scatter the free slots before timing
+	for (uint32_t i = 0U; i < POOL_SIZE * 4U; ++i)
+	{
+		auto& pObject = objects[random() % live];
+		pool.Pop(pObject);
+		pObject = pool.Get();
+	}
+
+	std::vector<uint32_t> picks(STEPS);
+	for (auto& pick : picks)
+		pick = random() % live;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	for (const uint32_t pick : picks)
+	{
+		pool.Pop(objects[pick]);
+		objects[pick] = pool.Get();
+	}
+
+	const auto time = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+
+	for (auto pObject : objects)
+		pool.Pop(pObject);
+
+	return time / static_cast<double>(STEPS);
+}
+
+int main()
+{
+	std::printf("Alloc/free pairs, ns each\n");
+	std::printf("occupancy   Pool<%u>   PagedPool<%u>, %u pages\n", POOL_SIZE, PAGE_SIZE, POOL_SIZE / PAGE_SIZE);
+
+	for (const uint32_t percent : { 10U, 50U, 99U })
+	{
+		const uint32_t live = POOL_SIZE * percent / 100U;
+
+		auto pPool = std::make_unique<Pool<BenchObject, POOL_SIZE>>();
+		auto pPaged = std::make_unique<PagedPool<BenchObject, PAGE_SIZE>>();
+
+		// Grow the paged pool to the same capacity first, Trim is never called so the pages stay
+		std::vector<BenchObject*> fill;
+		for (uint32_t i = 0U; i < POOL_SIZE; ++i)
+			fill.push_back(pPaged->Get());
+		for (auto pObject : fill)
+			pPaged->Pop(pObject);
+
+		const double pool = MeasurePairs(*pPool, live);
+		const double paged = MeasurePairs(*pPaged, live);
+
+		std::printf("%3u%%        %8.1f   %8.1f\n", percent, pool, paged);
+	}
+
+	return 0;
+}
@@ -27,8 +27,9 @@ void LifeSpan::Update(float dt)
 {
 	m_Life += dt;
 
+	// Deferred, other systems might be running along side this one
 	if (m_Life > m_LifeSpan)
-		m_pOwner->GetWorld()->DestroyEntity(m_pOwner->GetId());
+		m_pOwner->GetWorld()->AsyncDestroyEntity(m_pOwner->GetId());
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -86,14 +87,7 @@ void ParticleEmitter::SpawnParticles([[maybe_unused]] float dt)
 		return;
 
 	const XMFLOAT2 pos = { m_pTransform->position.x, m_pTransform->position.y };
-	for (uint32_t i = 0; i < m_ParticlesPerSpawn; ++i)
-	{
-		float angle = (float)Utils::RandInterval(0, 360) * (float)M_PI / 180.f;
-
-		XMFLOAT2 accel{ cosf(angle) * 500.f, sinf(angle) * 500.f };
-
-		Prefabs::SpawnParticle(m_pOwner->GetWorld(), m_pSpriteBatch, pos, accel, { 1.f, .3f, 0.3f, 1.f }, m_ParticleLifeTime, m_Gravity);
-	}
+	Prefabs::SpawnParticleBurst(m_pOwner->GetWorld(), m_pSpriteBatch, pos, m_ParticlesPerSpawn, { 500.f, 500.f }, false, { 1.f, .3f, 0.3f, 1.f }, m_ParticleLifeTime, m_Gravity);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -129,7 +123,10 @@ void Particle::Update(float dt)
 	XMFLOAT4 colour = m_Colour;
 	m_Colour.y = abs(cosf(m_Timer * 3.f));
 	m_Colour.x = abs(sinf(m_Timer * 3.f));
+}
 
+void Particle::Render() const
+{
 	float scale = m_Scale - ((m_Scale / m_Life) * m_Timer);
 	m_pSpriteBatch->PushSprite({ 8, 128 - 16, 12, 132 - 16 }, { m_Pos.x, m_Pos.y, 0 }, 0, { scale, scale }, { 0.5f, 0.5f }, m_Colour);
 }
@@ -13,6 +13,9 @@ class LifeSpan
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	LifeSpan()
 		: m_LifeSpan(0.f)
 		, m_Life(0.f)
@@ -35,6 +38,9 @@ class ProjectileComponent
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<ColliderComponent>;
+
 	ProjectileComponent() = default;
 	ProjectileComponent(ECS::Entity* pE);
 
@@ -44,6 +50,12 @@ public:
 
 	inline void SetSpeed(float speed) { m_Speed = speed; }
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+		Repoint(m_pCollider, pFrom, pTo);
+	}
+
 private:
 	TransformComponent2D* m_pTransform;
 	ColliderComponent* m_pCollider;
@@ -59,6 +71,9 @@ class ParticleEmitter
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<TransformComponent2D>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	ParticleEmitter() = default;
 	ParticleEmitter(ECS::Entity* pE);
 
@@ -74,6 +89,11 @@ public:
 	void SpawnParticles(float dt);
 	inline void ToggleSpawning() { m_ShouldSpawn = !m_ShouldSpawn; }
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+	}
+
 private:
 	float m_Timer;
 	bool m_MeetsRequirements;
@@ -88,10 +108,17 @@ class Particle
 	: public ECS::EntityComponent
 {
 public:
+	// Only touches itself and the world's async destroy buffer
+	static constexpr bool ParallelUpdate = true;
+
 	Particle() = default;
 	Particle(ECS::Entity* pE);
 
 	void Update(float dt) override;
+
+	// Once a frame from MainGame::Render, the world can update any number of times per frame
+	void Render() const;
+
 	void Initialize(SpriteBatch* pSpriteBatch, XMFLOAT2 pos, XMFLOAT2 startAcceleration, float scale, XMFLOAT4 colour, float life, float gravity);
 
 private:
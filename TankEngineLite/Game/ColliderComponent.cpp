@@ -4,10 +4,6 @@
 
 void ColliderComponent::Update(float dt)
 {
-	// First frame of the game takes longer than it should in debug, whoops
-	if (dt > 1 / 60.f)
-		dt = 1 / 60.f;
-
 	m_PreviousPosition = m_pTransform->position;
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -92,6 +88,10 @@ void ColliderComponent::Update(float dt)
 		m_IsGrounded = false;
 	}
 
+	// Standing still doesn't count as a change
+	if (m_pTransform->position.x != m_PreviousPosition.x || m_pTransform->position.y != m_PreviousPosition.y)
+		m_pTransform->MarkChanged();
+
 	//////////////////////////////////////////////////////////////////////////
 	// Dynamic
 	if (!m_CollidesDynamic)
@@ -102,22 +102,40 @@ void ColliderComponent::Update(float dt)
 	if (m_DynamicCallbackTimer < m_DynamicCallbackDelay)
 		return;
 
-	m_pColliderSystem->ForAll([this](ECS::EntityComponent* pC)
-		{
-			if (this == pC) 
-				return;
-
-			const auto col = static_cast<ColliderComponent*>(pC);
-			auto otherTransform = col->GetTransform();
-
-			float x1 = otherTransform->position.x;
-			float y1 = otherTransform->position.y;
-			float x2 = otherTransform->position.x + col->GetSize().x;
-			float y2 = otherTransform->position.y + col->GetSize().y;
-
-			if (m_pTransform->position.x > x2 || x1 > m_pTransform->position.x + m_Size.x || m_pTransform->position.y > y2 || y1 > m_pTransform->position.y + m_Size.y)
-				return;
-				
-			m_OnDynamicCollisionCallback(pC->GetOwner());
-		});
+	// Only the colliders, not every slot of their pool
+	if (m_DynamicCollisionTags.empty())
+	{
+		m_pColliders->ForEach([this](ColliderComponent& col, TransformComponent2D& transform) { TestDynamicCollision(col, transform); });
+		return;
+	}
+
+	// Only the entities with the tags, the rest never become a candidate
+	const auto pWorld = m_pOwner->GetWorld();
+
+	for (const uint32_t tag : m_DynamicCollisionTags)
+	{
+		pWorld->ForEachTagged(tag, [this](ECS::Entity* pOther)
+			{
+				const auto [pCol, pTransform] = pOther->GetComponents<ColliderComponent, TransformComponent2D>();
+
+				if (pCol && pTransform)
+					TestDynamicCollision(*pCol, *pTransform);
+			});
+	}
+}
+
+void ColliderComponent::TestDynamicCollision(ColliderComponent& other, const TransformComponent2D& otherTransform)
+{
+	if (this == &other)
+		return;
+
+	float x1 = otherTransform.position.x;
+	float y1 = otherTransform.position.y;
+	float x2 = otherTransform.position.x + other.GetSize().x;
+	float y2 = otherTransform.position.y + other.GetSize().y;
+
+	if (m_pTransform->position.x > x2 || x1 > m_pTransform->position.x + m_Size.x || m_pTransform->position.y > y2 || y1 > m_pTransform->position.y + m_Size.y)
+		return;
+
+	m_OnDynamicCollisionCallback(other.GetOwner());
 }
\ No newline at end of file
@@ -10,15 +10,18 @@ class ColliderComponent
 	: public ECS::EntityComponent
 {
 public:
+	// Callbacks are std::functions, snapshots copy the component instead of taking its bytes
+	static constexpr bool SnapshotByCopy = true;
+
 	ColliderComponent() = default;
 
 	ColliderComponent(ECS::Entity* pE)
 		: ECS::EntityComponent(pE)
 	{
 		m_pTransform = pE->GetComponent<TransformComponent2D>();
-		m_pColliderSystem = m_pOwner->GetWorld()->GetSystemByComponent<ColliderComponent>();
+		m_pColliders = m_pOwner->GetWorld()->GetQuery<ColliderComponent, TransformComponent2D>();
 
-		if (m_pTransform && m_pColliderSystem)
+		if (m_pTransform && m_pColliders)
 			m_MeetsRequirements = true;
 	}
 
@@ -56,9 +59,20 @@ public:
 		m_CollidesDynamic = true; 
 	}
 
+	// Only test against entities with one of these tags, none tests against every collider
+	void SetDynamicCollisionTags(std::initializer_list<uint32_t> tags) { m_DynamicCollisionTags = tags; }
+
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+	}
+
 	void Update(float dt);
 
 private:
+	// Call the dynamic callback when overlapping the other collider
+	void TestDynamicCollision(ColliderComponent& other, const TransformComponent2D& otherTransform);
+
 	std::function<void()> m_OnCollisionXCallback{ []() {} };
 	std::function<void()> m_OnCollisionYCallback{ []() {} };
 	std::function<void(ECS::Entity*)> m_OnDynamicCollisionCallback{ [](ECS::Entity*) {} };
@@ -66,7 +80,8 @@ private:
 	float m_DynamicCallbackDelay = 0.f;
 	float m_DynamicCallbackTimer = 0.f;
 	TransformComponent2D* m_pTransform = nullptr;
-	ECS::System* m_pColliderSystem = nullptr;
+	ECS::Query<ColliderComponent, TransformComponent2D>* m_pColliders = nullptr;
+	std::vector<uint32_t> m_DynamicCollisionTags;
 	XMFLOAT2 m_Movement{};
 	XMFLOAT2 m_Acceleration{};
 	bool m_IsGrounded = true;
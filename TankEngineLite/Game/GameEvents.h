@@ -0,0 +1,27 @@
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+//////////////////////////////////////////////////////////////////////////
+// Entity tags, the world keeps a set of the entities with each, see ECS::World::GetTagged
+namespace Tags
+{
+	constexpr uint32_t ENEMY = 32U;
+	constexpr uint32_t PLAYER = 69U;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Events sent between the game's components, see ECS::World::SendEvent
+
+// Hit by an enemy, a bolder or a bubble. Several hits in the same frame count as one
+struct DamageEvent
+{
+	static constexpr bool Coalesce = true;
+};
+
+// Points for a player, bursting a bubble or picking up food
+struct ScoreEvent
+{
+	int points;
+};
+
+#endif // !GAME_EVENTS_H
@@ -9,6 +9,8 @@
 #include "Model.h"
 
 #include "Profiler.h"
+#include "Simulation.h"
+#include "TransformSystem.h"
 #include "BinaryInterfaces.h"
 
 #include "Sound.h"
@@ -30,6 +32,12 @@ bool MainGame::IsRunning = false;
 BBLevel* MainGame::pCurrentLevel = nullptr;
 int MainGame::aliveEnemyCount = 0;
 int MainGame::alivePlayerCount = 0;
+Simulation* MainGame::pSimulation = nullptr;
+
+bool MainGame::IsResimulating()
+{
+	return pSimulation != nullptr && pSimulation->IsResimulating();
+}
 
 void MainGame::Initialize()
 {
@@ -46,14 +54,54 @@ void MainGame::Initialize()
 		WorldSystem<ColliderComponent, SMALL, 4, ExecutionStyle::SYNCHRONOUS>,
 		WorldSystem<PlayerController, TINY, 5, ExecutionStyle::SYNCHRONOUS>,
 		WorldSystem<ParticleEmitter, TINY, 6, ExecutionStyle::SYNCHRONOUS>,
-		WorldSystem<Particle, MED, 7, ExecutionStyle::ASYNCHRONOUS>,
-		WorldSystem<TransformComponent, TINY, 8, ExecutionStyle::SYNCHRONOUS>,
+		WorldSystem<Particle, SMALL, 7, ExecutionStyle::DYNAMIC, PoolStyle::PAGED>,
+		TransformSystem<TINY, 8, ExecutionStyle::SYNCHRONOUS>,
 		WorldSystem<CameraComponent, TINY, 9, ExecutionStyle::SYNCHRONOUS>,
 		WorldSystem<ModelRenderComponent, TINY, 10, ExecutionStyle::SYNCHRONOUS>,
 		WorldSystem<ZenChanController, TINY, 11, ExecutionStyle::ASYNCHRONOUS>,
-		WorldSystem<MaitaController, TINY, 12, ExecutionStyle::ASYNCHRONOUS>
+		WorldSystem<MaitaController, TINY, 12, ExecutionStyle::ASYNCHRONOUS>,
+		WorldSystem<HierarchyComponent, TINY, 13, ExecutionStyle::SYNCHRONOUS>
 	>();
 
+	// Events are handed to these systems in batch, once the world is done updating
+	m_pWorld->Subscribe<DamageEvent, PlayerController>();
+	m_pWorld->Subscribe<DamageEvent, ZenChanController>();
+	m_pWorld->Subscribe<DamageEvent, MaitaController>();
+	m_pWorld->Subscribe<ScoreEvent, PlayerController>();
+
+	// Entities spawned with these exact component sets live in chunked storage
+	m_pWorld->PushArchetypes<
+		Archetype<64, ProjectileComponent, ColliderComponent, LifeSpan, SpriteRenderComponent, TransformComponent2D>,
+		Archetype<8, ZenChanController, ColliderComponent, SpriteRenderComponent, TransformComponent2D>,
+		Archetype<8, MaitaController, ColliderComponent, SpriteRenderComponent, TransformComponent2D>
+	>();
+
+	// Sprites are drawn in pool order and read their transform, keep the two pools in step
+	m_pWorld->CoSortPools<TransformComponent2D, SpriteRenderComponent>();
+
+	// Fixed step, game state outside of the world goes back with it on rollback.
+	// The world reads MainGame's statics while updating, it stays on the main thread (not independent)
+	pSimulation = new (Memory::New<Simulation>()) Simulation(m_pWorld, 60U, 32U);
+	Universe::GetInstance()->SetWorldUpdate(m_pWorld, [this](World*, float dt)
+		{
+			// Frames that didn't have to catch up sort a bit of the pools
+			if (pSimulation->Advance(dt) <= 1U)
+				m_pWorld->SortPools(64U);
+		});
+	pSimulation->SetStateHooks(
+		[this](WorldSnapshot& snapshot)
+		{
+			snapshot.WriteValue(aliveEnemyCount);
+			snapshot.WriteValue(alivePlayerCount);
+			snapshot.Write(m_pPlayers, sizeof(m_pPlayers));
+		},
+		[this](SnapshotReader& reader)
+		{
+			aliveEnemyCount = reader.ReadValue<int>();
+			alivePlayerCount = reader.ReadValue<int>();
+			reader.Read(m_pPlayers, sizeof(m_pPlayers));
+		});
+
 	// Initialize custom resource loaders
 	ResourceManager::AddTypeResolver(
 		std::pair(".bmap", [](std::string path, std::string name) { RESOURCES->Load<BBLevel>(path, name); })
@@ -151,6 +199,9 @@ void MainGame::Load([[maybe_unused]] ResourceManager* pResourceManager, [[maybe_
 				uint32_t controller = m_NextControllerIndex++;
 				MainGame::alivePlayerCount++;
 				m_pPlayers[controller] = Prefabs::CreatePlayer(m_pWorld, m_pDynamic_SB, { 84, 900 - 144 }, (Player)controller);
+
+				// Joining isn't something a rollback should undo
+				pSimulation->ClearHistory();
 			}));
 
 	//////////////////////////////////////////////////////////////////////////
@@ -170,6 +221,61 @@ void MainGame::Load([[maybe_unused]] ResourceManager* pResourceManager, [[maybe_
 		m_pPlayers[controller] = Prefabs::CreatePlayer(m_pWorld, m_pDynamic_SB, { 84, 900 - 144 }, (Player)controller);
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Debug save states, the world plus the game state that lives outside of it
+	InputManager::GetInstance()->RegisterActionMappin(
+		ActionMapping(SDL_SCANCODE_F5, ActionType::PRESSED,
+			[this]()
+			{
+				if (m_State != PLAYING)
+					return;
+
+				m_pWorld->CaptureSnapshot(m_QuickSave.snapshot);
+				std::copy(std::begin(m_pPlayers), std::end(m_pPlayers), std::begin(m_QuickSave.pPlayers));
+				m_QuickSave.pLevel = pCurrentLevel;
+				m_QuickSave.mapIndex = m_MapIndex;
+				m_QuickSave.aliveEnemyCount = aliveEnemyCount;
+				m_QuickSave.alivePlayerCount = alivePlayerCount;
+				m_QuickSave.nextControllerIndex = m_NextControllerIndex;
+			}));
+
+	InputManager::GetInstance()->RegisterActionMappin(
+		ActionMapping(SDL_SCANCODE_F9, ActionType::PRESSED,
+			[this]()
+			{
+				if (m_QuickSave.snapshot.IsEmpty())
+					return;
+
+				m_pWorld->RestoreSnapshot(m_QuickSave.snapshot);
+				std::copy(std::begin(m_QuickSave.pPlayers), std::end(m_QuickSave.pPlayers), std::begin(m_pPlayers));
+
+				if (pCurrentLevel != m_QuickSave.pLevel)
+				{
+					pCurrentLevel = m_QuickSave.pLevel;
+					pCurrentLevel->SetupBatch(m_pStatic_SB);
+				}
+
+				m_MapIndex = m_QuickSave.mapIndex;
+				aliveEnemyCount = m_QuickSave.aliveEnemyCount;
+				alivePlayerCount = m_QuickSave.alivePlayerCount;
+				m_NextControllerIndex = m_QuickSave.nextControllerIndex;
+				m_Timer = 0.f;
+				m_State = PLAYING;
+
+				// The recorded ticks lead up to the state that was just thrown away
+				pSimulation->ClearHistory();
+			}));
+
+	//////////////////////////////////////////////////////////////////////////
+	// Debug rollback, go back 8 ticks and simulate them again with the recorded input
+	InputManager::GetInstance()->RegisterActionMappin(
+		ActionMapping(SDL_SCANCODE_F6, ActionType::PRESSED,
+			[this]()
+			{
+				if (m_State == PLAYING)
+					pSimulation->Rollback(8U);
+			}));
+
 	//////////////////////////////////////////////////////////////////////////
 	// Start play
 	InputManager::GetInstance()->RegisterActionMappin(
@@ -204,7 +310,9 @@ void MainGame::Update([[maybe_unused]] float dt, [[maybe_unused]] InputManager*
 			m_Timer = 0;
 			m_State = PLAYING;
 
-			m_pWorld->MessageAll(128U);
+			// Clear out the enemies still around, the new level spawns its own
+			m_pWorld->ForEach<ZenChanController>([this](ZenChanController& c) { m_pWorld->AsyncDestroyEntity(c.GetOwner()->GetId()); });
+			m_pWorld->ForEach<MaitaController>([this](MaitaController& c) { m_pWorld->AsyncDestroyEntity(c.GetOwner()->GetId()); });
 
 			m_MapIndex = 0;
 			// This is horrible
@@ -293,13 +401,15 @@ void MainGame::Update([[maybe_unused]] float dt, [[maybe_unused]] InputManager*
 	m_pStatic_SB->SetScale(m_CurrentScale);
 
 	PROFILE(SESSION_UPDATE_ECS, ECS::Universe::GetInstance()->Update(dt));
+	pSimulation->ImGuiDebug();
 }
 
 void MainGame::Render([[maybe_unused]] Renderer* pRenderer)
 {
 	// Populate sprite batches
-	PROFILE(SESSION_RENDER_ECS, pRenderer->SpriteBatchRender(m_pWorld->GetSystemByComponent<SpriteRenderComponent>()));
-	PROFILE(SESSION_RENDER_ECS, pRenderer->ModelRender(m_pWorld->GetSystemByComponent<ModelRenderComponent>()));
+	PROFILE(SESSION_RENDER_ECS, pRenderer->SpriteBatchRender(m_pWorld));
+	PROFILE(SESSION_RENDER_ECS, pRenderer->ModelRender(m_pWorld));
+	PROFILE(SESSION_RENDER_ECS, m_pWorld->ForEach<Particle>([](Particle& particle) { particle.Render(); }));
 
 	// Render your sprite batches
 	Profiler::GetInstance()->BeginSubSession<SESSION_BATCH_RENDERING>();
@@ -319,6 +429,9 @@ void MainGame::Shutdown()
 
 	m_pStatic_SB->Destroy();
 	Memory::Delete(m_pStatic_SB);
+
+	Memory::Delete(pSimulation);
+	pSimulation = nullptr;
 }
 
 void MainGame::LoadLevel(const std::string& level, bool score)
@@ -326,6 +439,13 @@ void MainGame::LoadLevel(const std::string& level, bool score)
 	MainGame::aliveEnemyCount = 0;
 	MainGame::alivePlayerCount = 0;
 
+	// Rolling back in to the previous level would leave pCurrentLevel pointing at this one
+	pSimulation->ClearHistory();
+
+	// Hand the particle pages of the last level back, unless a quick save still points in to them
+	if (m_QuickSave.snapshot.IsEmpty())
+		m_pWorld->TrimPools();
+
 	pCurrentLevel = RESOURCES->Get<BBLevel>(level);
 	pCurrentLevel->SetupBatch(m_pStatic_SB);
 
@@ -387,7 +507,10 @@ void MainGame::LoadLevel(const std::string& level, bool score)
 	{
 		if (m_pPlayers[i])
 		{
-			m_pPlayers[i]->GetComponent<TransformComponent2D>()->position = { 84, 900 - 144, 0.f };
+			const auto pTransform = m_pPlayers[i]->GetComponent<TransformComponent2D>();
+			pTransform->position = { 84, 900 - 144, 0.f };
+			pTransform->MarkChanged();
+
 			m_pPlayers[i]->GetComponent<PlayerController>()->Reset(score);
 			MainGame::alivePlayerCount++;
 		}
@@ -410,7 +533,15 @@ void MainGame::CameraTransitions(float dt)
 	}
 
 	float cameraInterpDT = dt;
-	XMStoreFloat3(&m_pCameraTransform->position, XMVectorLerp(XMLoadFloat3(&m_pCameraTransform->position), XMLoadFloat3(&m_IntendedPosition), cameraInterpDT));
+	const auto cameraPosition = XMLoadFloat3(&m_pCameraTransform->position);
+	const auto targetPosition = XMLoadFloat3(&m_IntendedPosition);
+
+	// Once it's settled leave the transform alone, the view matrix only gets rebuilt when it changes
+	if (!XMVector3NearEqual(cameraPosition, targetPosition, XMVectorReplicate(0.001f)))
+	{
+		XMStoreFloat3(&m_pCameraTransform->position, XMVectorLerp(cameraPosition, targetPosition, cameraInterpDT));
+		m_pCameraTransform->MarkChanged();
+	}
 	m_CurrentScale = Utils::Lerp(m_CurrentScale, m_IntendedScale, dt * 4);
 	m_pDynamic_SB->SetScale(m_CurrentScale);
 	m_pStatic_SB->SetScale(m_CurrentScale);
@@ -8,6 +8,7 @@ class BBLevel;
 class Entity;
 class Sound;
 class World;
+class Simulation;
 
 namespace FMOD
 {
@@ -31,6 +32,12 @@ public:
 	static int aliveEnemyCount;
 	static int alivePlayerCount;
 
+	// Steps the world at a fixed rate and keeps the last ticks around, F6 rolls back and resimulates them
+	static Simulation* pSimulation;
+
+	// True while a rollback runs ticks again, sounds, rumble and logs already happened the first time
+	static bool IsResimulating();
+
 	void LoadLevel(const std::string& level, bool score = false);
 
 private:
@@ -69,6 +76,18 @@ private:
 
 	// Keep track of players for connect/disconnect
 	ECS::Entity* m_pPlayers[4]{ nullptr, nullptr, nullptr, nullptr };
+
+	// Debug save state, F5 to save and F9 to load while playing
+	struct QuickSave
+	{
+		ECS::WorldSnapshot snapshot;
+		ECS::Entity* pPlayers[4];
+		BBLevel* pLevel;
+		int mapIndex;
+		int aliveEnemyCount;
+		int alivePlayerCount;
+		uint32_t nextControllerIndex;
+	} m_QuickSave{};
 };
 
 #endif // !MAIN_GAME_H
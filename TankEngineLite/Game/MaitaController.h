@@ -3,6 +3,7 @@
 
 #include "CoreComponents.h"
 #include "ColliderComponent.h"
+#include "GameEvents.h"
 
 #include <array>
 
@@ -14,9 +15,16 @@ public:
 	MaitaController(ECS::Entity* pE);
 
 	void Update(float dt);
-	void OnMessage(uint32_t message);
+	void OnEvent(const DamageEvent& event);
 	void SetPlayers(const std::array<TransformComponent2D*, 4>& playerTransforms) noexcept { m_Players = playerTransforms; }
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+		Repoint(m_pRenderComponent, pFrom, pTo);
+		Repoint(m_pCollider, pFrom, pTo);
+	}
+
 private:
 	enum MaitaStates
 	{
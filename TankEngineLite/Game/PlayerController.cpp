@@ -40,50 +40,50 @@ void PlayerController::Update(float dt)
 	}
 }
 
-void PlayerController::OnMessage(uint32_t message)
+void PlayerController::OnEvent([[maybe_unused]] const DamageEvent& event)
 {
 	// Take Damage
-	if (m_DamageTimer > 1.f && message == 0U)
+	if (m_DamageTimer > 1.f)
 	{
 		--m_Health;
 		m_DamageTimer = 0.f;
 		
-		SOUND->Play(m_pDamage);
+		if (!MainGame::IsResimulating())
+			SOUND->Play(m_pDamage);
 
 		if (m_Health <= 0U)
 		{
 			m_StatE = PlayerState::DEAD;
-			SOUND->Play(m_pDeath);
 			--MainGame::alivePlayerCount;
+
+			if (!MainGame::IsResimulating())
+				SOUND->Play(m_pDeath);
 		}
 
 		auto pos = m_pTransform->position;
 		pos.x += 32.f;
 		pos.y += 32.f;
 
-		InputManager::GetInstance()->RumbleController(35000, 35000, 0.2f, m_PlayerController);
-		ParticleSphere();
-	}
+		if (!MainGame::IsResimulating())
+			InputManager::GetInstance()->RumbleController(35000, 35000, 0.2f, m_PlayerController);
 
-	// Burst bubble or eat water melon gives you 100 points
-	if (message == 1U)
-	{
-		LOGGER->Log<LOG_INFO>("100 SCORE");
-		InputManager::GetInstance()->RumbleController(35000, 35000, 0.2f, m_PlayerController);
-		m_Score += 100;
 		ParticleSphere();
-		SOUND->Play(m_pPickupSound);
 	}
+}
 
-	// Pizza
-	if (message == 2U)
-	{
-		LOGGER->Log<LOG_INFO>("200 SCORE");
-		InputManager::GetInstance()->RumbleController(35000, 35000, 0.2f, m_PlayerController);
-		m_Score += 200;
-		ParticleSphere();
-		SOUND->Play(m_pPickupSound);
-	}
+void PlayerController::OnEvent(const ScoreEvent& event)
+{
+	// Burst bubble or eat water melon gives you 100 points, pizza 200
+	m_Score += event.points;
+	ParticleSphere();
+
+	// Already heard and felt the first time this tick ran
+	if (MainGame::IsResimulating())
+		return;
+
+	LOGGER->Log<LOG_INFO>(std::to_string(event.points) + " SCORE");
+	InputManager::GetInstance()->RumbleController(35000, 35000, 0.2f, m_PlayerController);
+	SOUND->Play(m_pPickupSound);
 }
 
 void PlayerController::Reset(bool score)
@@ -136,13 +136,7 @@ void PlayerController::AliveUpdate(float dt)
 
 		// Spawn particles for jumping
 		const XMFLOAT2 pos = { m_pTransform->position.x + 32.f, m_pTransform->position.y + 64.f };
-		for (uint32_t i = 0; i < 10; ++i)
-		{
-			float angle = (float)Utils::RandInterval(0, 360) * (float)M_PI / 180.f;
-
-			XMFLOAT2 accel{ cosf(angle) * 100.f, -abs(sin(angle)) * 50.f };
-			Prefabs::SpawnParticle(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), pos, accel, { 0.0f, 1.f, .0f, 1.f }, 0.5f, 50.f);
-		}
+		Prefabs::SpawnParticleBurst(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), pos, 10U, { 100.f, 50.f }, true, { 0.0f, 1.f, .0f, 1.f }, 0.5f, 50.f);
 
 		// Actually jump
 		m_pCollider->AddAcceleration({ 0.f, -1750.f });
@@ -173,13 +167,16 @@ void PlayerController::AliveUpdate(float dt)
 
 			m_Timer -= m_Timer;
 
-			// Rumble in the firing direction
-			if (m_FacingRight)
-				InputManager::GetInstance()->RumbleController(0, 35000, 0.1f, m_PlayerController);
-			else
-				InputManager::GetInstance()->RumbleController(35000, 0, 0.1f, m_PlayerController);
+			if (!MainGame::IsResimulating())
+			{
+				// Rumble in the firing direction
+				if (m_FacingRight)
+					InputManager::GetInstance()->RumbleController(0, 35000, 0.1f, m_PlayerController);
+				else
+					InputManager::GetInstance()->RumbleController(35000, 0, 0.1f, m_PlayerController);
 
-			SOUND->Play(m_pShootingSound);
+				SOUND->Play(m_pShootingSound);
+			}
 		}
 	}
 
@@ -240,11 +237,5 @@ void PlayerController::DeadUpdate([[maybe_unused]] float dt)
 void PlayerController::ParticleSphere()
 {
 	const XMFLOAT2 pos = { m_pTransform->position.x + 32.f, m_pTransform->position.y + 64.f };
-	for (uint32_t i = 0; i < 10; ++i)
-	{
-		float angle = (float)Utils::RandInterval(0, 360) * (float)M_PI / 180.f;
-
-		XMFLOAT2 accel{ cosf(angle) * 100.f, -abs(sin(angle)) * 50.f };
-		Prefabs::SpawnParticle(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), pos, accel, { 0.0f, 1.f, .0f, 1.f }, 0.5f, 50.f);
-	}
+	Prefabs::SpawnParticleBurst(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), pos, 10U, { 100.f, 50.f }, true, { 0.0f, 1.f, .0f, 1.f }, 0.5f, 50.f);
 }
@@ -7,6 +7,7 @@
 #include "SoundManager.h"
 #include "ResourceManager.h"
 #include "ColliderComponent.h"
+#include "GameEvents.h"
 
 class PlayerController
 	: public ECS::EntityComponent
@@ -16,7 +17,8 @@ public:
 	PlayerController(ECS::Entity* pE);
 
 	void Update(float dt) override;
-	void OnMessage(uint32_t message) override;
+	void OnEvent(const DamageEvent& event);
+	void OnEvent(const ScoreEvent& event);
 	inline void SetInputController(Player player) { m_PlayerController = player; }
 
 	constexpr auto GetIsDead() const noexcept -> bool { return (int)m_StatE == 0; }
@@ -25,6 +27,13 @@ public:
 
 	void Reset(bool score = false);
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+		Repoint(m_pRenderComponent, pFrom, pTo);
+		Repoint(m_pCollider, pFrom, pTo);
+	}
+
 private:
 	enum PlayerState
 	{
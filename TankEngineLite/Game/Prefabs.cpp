@@ -34,14 +34,14 @@ ECS::Entity* Prefabs::CreateBubbleProjectile(ECS::World* pWorld, const XMFLOAT2&
 
 	FMOD::Sound* pBubbleSound = RESOURCES->Get<Sound>("bubble")->GetSound();
 
+	pCollider->SetDynamicCollisionTags({ Tags::ENEMY });
 	pCollider->SetOnDynamicCollisionCB([pEntity, pWorld, pBubbleSound]([[maybe_unused]] ECS::Entity* pOther)
 		{
-			if (pOther->GetTag() == 32U)
-			{
-				pOther->Message(0U);
-				pWorld->AsyncDestroyEntity(pEntity->GetId());
+			pWorld->SendEvent(pOther->GetId(), DamageEvent{});
+			pWorld->AsyncDestroyEntity(pEntity->GetId());
+
+			if (!MainGame::IsResimulating())
 				SOUND->Play(pBubbleSound);
-			}
 		});
 
 	pCollider->SetOnCollisionCB_X([pEntity, pWorld]()
@@ -69,20 +69,15 @@ ECS::Entity* Prefabs::SpawnScoreItem(ECS::World* pWorld, SpriteBatch* pSpriteBat
 	else
 		pRenderer->SetAtlasTransform({ 32, 128,  48, 144 });
 
-	pCollider->SetOnDynamicCollisionCB([pEntity, pWorld, type, pRenderer, &pos]([[maybe_unused]] ECS::Entity* pOther)
+	pCollider->SetDynamicCollisionTags({ Tags::PLAYER });
+	pCollider->SetOnDynamicCollisionCB([pEntity, pWorld, type, pSpriteBatch]([[maybe_unused]] ECS::Entity* pOther)
 		{
-			if (pOther->GetTag() == 69U)
-			{
-				if (type == ScoreType::PIZZA)
-					pOther->Message(2U);
-				else
-					pOther->Message(1U);
-
-				const auto tr = pEntity->GetComponent<TransformComponent2D>()->position;
-
-				Prefabs::SpawnScore(pEntity->GetWorld(), pRenderer->GetSpriteBatch(), { tr.x, tr.y }, type);
-				pWorld->AsyncDestroyEntity(pEntity->GetId());
-			}
+			pWorld->SendEvent(pOther->GetId(), ScoreEvent{ (type == ScoreType::PIZZA) ? 200 : 100 });
+
+			const auto tr = pEntity->GetComponent<TransformComponent2D>()->position;
+
+			Prefabs::SpawnScore(pEntity->GetWorld(), pSpriteBatch, { tr.x, tr.y }, type);
+			pWorld->AsyncDestroyEntity(pEntity->GetId());
 		}, 0.5f);
 
 	return pEntity;
@@ -133,13 +128,11 @@ ECS::Entity* Prefabs::ShootBolder(ECS::World* pWorld, SpriteBatch* pSpriteBatch,
 			pProjectile->SetDirection(direction);
 			pProjectile->SetSpeed(300.f);
 
+			pCollider->SetDynamicCollisionTags({ Tags::PLAYER });
 			pCollider->SetOnDynamicCollisionCB([pEntity, pWorld]([[maybe_unused]] ECS::Entity* pOther)
 				{
-					if (pOther->GetTag() == 69U)
-					{
-						pOther->Message(0U);
-						pWorld->AsyncDestroyEntity(pEntity->GetId());
-					}
+					pWorld->SendEvent(pOther->GetId(), DamageEvent{});
+					pWorld->AsyncDestroyEntity(pEntity->GetId());
 				});
 
 			pCollider->SetOnCollisionCB_X([pEntity, pWorld, pC]()
@@ -168,7 +161,7 @@ ECS::Entity* Prefabs::CreatePlayer(ECS::World* pWorld, SpriteBatch* pSpriteBatch
 
 	pMovement->SetInputController(player);
 
-	pEntity->SetTag(69U);
+	pEntity->SetTag(Tags::PLAYER);
 
 	return pEntity;
 }
@@ -184,7 +177,7 @@ ECS::Entity* Prefabs::CreateZenChan(ECS::World* pWorld, SpriteBatch* pSpriteBatc
 
 	pTransform->position = { pos.x, pos.y, pos.z };
 	pTransform->scale = { 4.f, 4.f };
-	ai->SetTag(32U);
+	ai->SetTag(Tags::ENEMY);
 
 	pController->SetPlayers(playerTransforms);
 
@@ -202,7 +195,7 @@ ECS::Entity* Prefabs::CreateMaita(ECS::World* pWorld, SpriteBatch* pSpriteBatch,
 
 	pTransform->position = { pos.x, pos.y, pos.z };
 	pTransform->scale = { 4.f, 4.f };
-	ai->SetTag(32U);
+	ai->SetTag(Tags::ENEMY);
 
 	pController->SetPlayers(playerTransforms);
 
@@ -232,3 +225,19 @@ ECS::Entity* Prefabs::SpawnParticle(ECS::World* pWorld, SpriteBatch* pSpriteBatc
 
 	return nullptr;
 }
+
+void Prefabs::SpawnParticleBurst(ECS::World* pWorld, SpriteBatch* pSpriteBatch, XMFLOAT2 pos, uint32_t count, XMFLOAT2 speed, bool upwards, XMFLOAT4 colour, float life, float gravity)
+{
+	static const ECS::Prefab<Particle> particlePrefab{};
+
+	pWorld->AsyncSpawnBatch(particlePrefab, count,
+		[pWorld, pSpriteBatch, pos, speed, upwards, colour, life, gravity]([[maybe_unused]] ECS::Entity* pEntity, Particle* pParticle)
+		{
+			// Runs when the batch gets flushed, on the main thread, so the world's random sequence stays in order
+			const float angle = (float)Utils::RandInterval(pWorld->GetRandom(), 0, 360) * (float)M_PI / 180.f;
+			const float vertical = upwards ? -abs(sinf(angle)) : sinf(angle);
+
+			pParticle->Initialize(pSpriteBatch, pos, { cosf(angle) * speed.x, vertical * speed.y }, 0.35f, colour, life, gravity);
+		}
+	);
+}
@@ -13,6 +13,10 @@ public:
 	static ECS::Entity* CreateBubbleProjectile(ECS::World* pWorld, const XMFLOAT2& position, const XMFLOAT2& direction, SpriteBatch* pSpriteBatch);
 	static ECS::Entity* SpawnCamera(ECS::World* pWorld, XMFLOAT3 pos);
 	static ECS::Entity* SpawnParticle(ECS::World* pWorld, SpriteBatch* pSpriteBatch, XMFLOAT2 pos, XMFLOAT2 startingAcceleration, XMFLOAT4 colour, float life, float gravity);
+
+	// count particles flying out in random directions at the given speed, with upwards only in the upper half.
+	//  Spawned as one batch at the world's sync point
+	static void SpawnParticleBurst(ECS::World* pWorld, SpriteBatch* pSpriteBatch, XMFLOAT2 pos, uint32_t count, XMFLOAT2 speed, bool upwards, XMFLOAT4 colour, float life, float gravity);
 	
 	enum ScoreType
 	{
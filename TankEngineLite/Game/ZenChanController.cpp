@@ -18,10 +18,11 @@ ZenChanController::ZenChanController(ECS::Entity* pE)
 				m_FacingRight = !m_FacingRight;
 			});
 
+		// Only the players can be hit, or burst the bubble
+		m_pCollider->SetDynamicCollisionTags({ Tags::PLAYER });
 		m_pCollider->SetOnDynamicCollisionCB([](ECS::Entity* pE)
 			{
-				if (pE->GetTag() == 69U)
-					pE->Message(0U);
+				pE->GetWorld()->SendEvent(pE->GetId(), DamageEvent{});
 			});
 
 		m_MeetsRequirements = true;
@@ -86,8 +87,7 @@ void ZenChanController::Update(float dt)
 			// Reset callback
 			m_pCollider->SetOnDynamicCollisionCB([](ECS::Entity* pE)
 				{
-					if (pE->GetTag() == 69U)
-						pE->Message(0U);
+					pE->GetWorld()->SendEvent(pE->GetId(), DamageEvent{});
 				});
 		}
 		break;
@@ -131,39 +131,28 @@ void ZenChanController::Update(float dt)
 	}
 }
 
-void ZenChanController::OnMessage(uint32_t message)
+void ZenChanController::OnEvent([[maybe_unused]] const DamageEvent& event)
 {
-	if (message == 128U)
-		m_pOwner->GetWorld()->AsyncDestroyEntity(m_pOwner->GetId());
-
-	if (message == 0U && m_State == ZCStates::NORMAL)
+	if (m_State == ZCStates::NORMAL)
 	{
 		m_State = ZCStates::IN_BUBBLE;
 		Prefabs::SpawnScore(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { m_pTransform->position.x, m_pTransform->position.y }, Prefabs::WATERMELON);
 
 		m_pCollider->SetOnDynamicCollisionCB([this](ECS::Entity* pE)
 			{
-				if (pE->GetTag() == 69U)
-				{
-					if (MainGame::alivePlayerCount > 0)
-						MainGame::aliveEnemyCount--;
-
-					pE->Message(1U);
-					m_pOwner->GetWorld()->AsyncDestroyEntity(m_pOwner->GetId());
-
-					auto pos = m_pTransform->position;
-					pos.x += 32.f;
-					pos.y += 32.f;
-
-					for (uint32_t i = 0; i < 10; ++i)
-					{
-						float angle = (float)Utils::RandInterval(0, 360) * (float)M_PI / 180.f;
-						XMFLOAT2 accel{ cosf(angle) * 100.f, sin(angle) * 100.f };
-						Prefabs::SpawnParticle(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x, pos.y }, accel, { 0.0f, 1.f, 0.f, 1.f }, 0.5f, 50.f);
-					}
-					Prefabs::SpawnScoreItem(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x - 32.f, pos.y - 32.f }, Prefabs::WATERMELON);
-					Prefabs::SpawnScore(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x - 32.f, pos.y - 32.f }, Prefabs::WATERMELON);
-				}
+				if (MainGame::alivePlayerCount > 0)
+					MainGame::aliveEnemyCount--;
+
+				pE->GetWorld()->SendEvent(pE->GetId(), ScoreEvent{ 100 });
+				m_pOwner->GetWorld()->AsyncDestroyEntity(m_pOwner->GetId());
+
+				auto pos = m_pTransform->position;
+				pos.x += 32.f;
+				pos.y += 32.f;
+
+				Prefabs::SpawnParticleBurst(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x, pos.y }, 10U, { 100.f, 100.f }, false, { 0.0f, 1.f, 0.f, 1.f }, 0.5f, 50.f);
+				Prefabs::SpawnScoreItem(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x - 32.f, pos.y - 32.f }, Prefabs::WATERMELON);
+				Prefabs::SpawnScore(m_pOwner->GetWorld(), m_pRenderComponent->GetSpriteBatch(), { pos.x - 32.f, pos.y - 32.f }, Prefabs::WATERMELON);
 			});
 	}
 }
@@ -0,0 +1,416 @@
+//////////////////////////////////////////////////////////////////////////
+// archetype.h: Chunked SoA component storage for the ECS, entities that share
+//		the same component set live in fixed size chunks with one contiguous
+//		array per component type
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include <type_traits>
+#include <functional>
+#include <typeindex>
+#include <algorithm>
+#include <vector>
+#include <tuple>
+
+#ifdef DEBUG_POOL
+#include <string>
+#include "imgui.h"
+#endif // DEBUG_POOL
+
+#include "MemoryTracker.h"
+#include "Snapshot.h"
+#include "Pool.h"
+
+namespace ECS
+{
+
+class Entity;
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: ArchetypeIndexOf<typename T, typename... Ts>
+// Description: Compile time index of T inside the pack Ts
+template<typename T, typename... Ts>
+struct ArchetypeIndexOf;
+
+template<typename T, typename... Ts>
+struct ArchetypeIndexOf<T, T, Ts...> : std::integral_constant<uint32_t, 0U> {};
+
+template<typename T, typename U, typename... Ts>
+struct ArchetypeIndexOf<T, U, Ts...> : std::integral_constant<uint32_t, 1U + ArchetypeIndexOf<T, Ts...>::value> {};
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    MakeArchetypeSignature
+// FullName:  ECS::MakeArchetypeSignature<typename... Ts>
+// Access:    public
+// Returns:   std::vector<std::type_index>
+// Description: Sorted list of component types, order of Ts does not matter
+template<typename... Ts>
+inline std::vector<std::type_index> MakeArchetypeSignature()
+{
+	std::vector<std::type_index> signature{ std::type_index(typeid(Ts))... };
+	std::sort(signature.begin(), signature.end());
+	return signature;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: ArchetypeColumn
+// Description: One component column of one chunk, row i is alive when (pRowMask[i] & columnBit) != 0
+struct ArchetypeColumn
+{
+	void* pData;
+	const uint32_t* pRowMask;
+	uint32_t columnBit;
+	uint32_t rowCount;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: ArchetypeBase
+// Description: Type erased interface the world and entities use to talk to an archetype
+class ArchetypeBase
+{
+public:
+	virtual ~ArchetypeBase() = default;
+
+	// Claim a row, no component is constructed until GetSlot is called for it
+	virtual uint32_t Reserve() = 0;
+
+	// Raw storage for the component of the given type on the given row, marks it as alive
+	virtual void* GetSlot(std::type_index type, uint32_t row) = 0;
+
+	// Destroy a single component, the row is released once all its components are gone.
+	//	Returns true when the row got released
+	virtual bool Pop(std::type_index type, uint32_t row) = 0;
+
+	virtual void ForAllColumn(std::type_index type, const std::function<void(void*)>& f) = 0;
+
+	// Hand over the column of the given type chunk by chunk, callers can walk the rows with a typed loop
+	virtual void ForEachColumnChunk(std::type_index type, const std::function<void(const ArchetypeColumn&)>& f) = 0;
+	virtual bool HasColumn(std::type_index type) const = 0;
+	virtual uint32_t GetActiveCount() const = 0;
+	virtual void ImGuiDebugUi() = 0;
+
+	// Write every chunk to a snapshot, and bring them back to that state.
+	//	CanRestore steps over the same part and says whether RestoreSnapshot would get through it
+	virtual void SaveSnapshot(WorldSnapshot& snapshot) const = 0;
+	virtual bool CanRestore(SnapshotReader& reader) const = 0;
+	virtual void RestoreSnapshot(SnapshotReader& reader) = 0;
+
+	[[nodiscard]] inline auto GetSignature() const noexcept -> const std::vector<std::type_index>& { return m_Signature; }
+
+protected:
+	std::vector<std::type_index> m_Signature;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Archetype<uint32_t N, typename... Ts>
+// Description: Stores entities that have exactly the components Ts... in chunks of N rows,
+//	every chunk holds one T[N] array per component type.
+//	Iterating through ForEach is a linear walk over the columns, no hashing and no virtual calls
+template<uint32_t N, typename... Ts>
+class Archetype final
+	: public ArchetypeBase
+{
+	static_assert(N % 8 == 0, "Archetype chunk size must be a multiple of 8");
+	static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) <= 32, "Archetype supports between 1 and 32 component types");
+
+	using ColumnMask = uint32_t;
+
+	template<typename T>
+	static constexpr ColumnMask BitOf = 1U << ArchetypeIndexOf<T, Ts...>::value;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Struct: Chunk
+	// Description: N rows, one contiguous array per component and a mask of alive columns per row
+	struct Chunk
+	{
+		std::tuple<Ts*...> columns;
+		ColumnMask rowMask[N];
+		bool rowReserved[N];
+		uint32_t activeCount;
+	};
+
+public:
+	Archetype()
+	{
+		m_Signature = MakeArchetypeSignature<Ts...>();
+	}
+
+	~Archetype() override
+	{
+		for (auto pChunk : m_Chunks)
+		{
+			// Destroy whatever is still alive, then release the columns
+			for (uint32_t i = 0; i < N; ++i)
+				DestroyRow(pChunk, i, pChunk->rowMask[i]);
+
+			std::apply([](auto* ... pColumns) { (Memory::Delete(pColumns, false), ...); }, pChunk->columns);
+			Memory::Delete(pChunk);
+		}
+	}
+
+	RO5(Archetype);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Reserve
+	// FullName:  Archetype::Reserve
+	// Access:    public
+	// Returns:   uint32_t
+	// Description: Claim a free row, allocates a new chunk when all chunks are full
+	uint32_t Reserve() override
+	{
+		if (m_FreeRows.empty())
+			PushChunk();
+
+		const uint32_t row = m_FreeRows.back();
+		m_FreeRows.pop_back();
+
+		auto pChunk = m_Chunks[row / N];
+		pChunk->rowReserved[row % N] = true;
+		pChunk->rowMask[row % N] = 0U;
+		pChunk->activeCount++;
+		m_ActiveCount++;
+
+		return row;
+	}
+
+	void* GetSlot(std::type_index type, uint32_t row) override
+	{
+		void* pSlot = nullptr;
+		auto pChunk = m_Chunks[row / N];
+		const uint32_t local = row % N;
+
+		// Find the column matching type
+		((type == std::type_index(typeid(Ts)) ?
+			(pSlot = &std::get<Ts*>(pChunk->columns)[local], pChunk->rowMask[local] |= BitOf<Ts>, 0) : 0), ...);
+
+		return pSlot;
+	}
+
+	bool Pop(std::type_index type, uint32_t row) override
+	{
+		auto pChunk = m_Chunks[row / N];
+		const uint32_t local = row % N;
+
+		ColumnMask bit = 0U;
+		((type == std::type_index(typeid(Ts)) ? (bit = BitOf<Ts>, 0) : 0), ...);
+
+		DestroyRow(pChunk, local, pChunk->rowMask[local] & bit);
+		pChunk->rowMask[local] &= ~bit;
+
+		// Last component of the row is gone, give the row back
+		if (pChunk->rowMask[local] == 0U && pChunk->rowReserved[local])
+		{
+			pChunk->rowReserved[local] = false;
+			pChunk->activeCount--;
+			m_ActiveCount--;
+			m_FreeRows.push_back(row);
+			return true;
+		}
+
+		return false;
+	}
+
+	void ForAllColumn(std::type_index type, const std::function<void(void*)>& f) override
+	{
+		((type == std::type_index(typeid(Ts)) ?
+			(ForEach<Ts>([&f](Ts& c) { f(&c); }), 0) : 0), ...);
+	}
+
+	void ForEachColumnChunk(std::type_index type, const std::function<void(const ArchetypeColumn&)>& f) override
+	{
+		((type == std::type_index(typeid(Ts)) ? (ForEachColumnChunk<Ts>(f), 0) : 0), ...);
+	}
+
+	[[nodiscard]] bool HasColumn(std::type_index type) const override
+	{
+		return ((type == std::type_index(typeid(Ts))) || ...);
+	}
+
+	[[nodiscard]] uint32_t GetActiveCount() const override { return m_ActiveCount; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForEach
+	// FullName:  Archetype::ForEach<typename... Us, typename F>
+	// Access:    public
+	// Returns:   void
+	// Description: Linear iteration over all rows that have all of Us alive, f(Us&...)
+	// Parameter: F&& f
+	template<typename... Us, typename F>
+	void ForEach(F&& f)
+	{
+		static_assert(sizeof...(Us) > 0, "ForEach needs at least one component type");
+		constexpr ColumnMask mask = (BitOf<Us> | ...);
+
+		for (auto pChunk : m_Chunks)
+		{
+			if (pChunk->activeCount == 0U)
+				continue;
+
+			auto columns = std::make_tuple(std::get<Us*>(pChunk->columns)...);
+			const ColumnMask* pMask = pChunk->rowMask;
+
+			for (uint32_t i = 0; i < N; ++i)
+			{
+				if ((pMask[i] & mask) == mask)
+					f(std::get<Us*>(columns)[i]...);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SaveSnapshot
+	// FullName:  Archetype::SaveSnapshot
+	// Access:    public
+	// Returns:   void
+	// Description: Row state and columns of every chunk, each column as one block
+	// Parameter: WorldSnapshot & snapshot
+	void SaveSnapshot(WorldSnapshot& snapshot) const override
+	{
+		snapshot.WriteValue(static_cast<uint32_t>(m_Chunks.size()));
+		snapshot.WriteValue(m_ActiveCount);
+		snapshot.WritePaddedVector(m_FreeRows, m_Chunks.size() * N);
+
+		for (auto pChunk : m_Chunks)
+		{
+			snapshot.Write(pChunk->rowMask, sizeof(pChunk->rowMask));
+			snapshot.Write(pChunk->rowReserved, sizeof(pChunk->rowReserved));
+			snapshot.WriteValue(pChunk->activeCount);
+
+			(snapshot.WriteColumn(std::get<Ts*>(pChunk->columns), N, [pChunk](uint32_t i) { return (pChunk->rowMask[i] & BitOf<Ts>) != 0U; }), ...);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    CanRestore
+	// FullName:  Archetype::CanRestore
+	// Access:    public
+	// Returns:   bool
+	// Description: Read past what SaveSnapshot wrote without touching any chunk, false when the
+	//		snapshot has more chunks than the archetype. World::RestoreSnapshot asks before it destroys anything
+	// Parameter: SnapshotReader & reader
+	bool CanRestore(SnapshotReader& reader) const override
+	{
+		const uint32_t chunkCount = reader.ReadValue<uint32_t>();
+
+		if (chunkCount > m_Chunks.size())
+			return false;
+
+		reader.Read(sizeof(m_ActiveCount));
+		reader.SkipPaddedVector<uint32_t>(chunkCount * N);
+
+		for (uint32_t chunk = 0U; chunk < chunkCount; ++chunk)
+		{
+			reader.Read(sizeof(Chunk::rowMask) + sizeof(Chunk::rowReserved) + sizeof(Chunk::activeCount));
+			(reader.SkipColumn<Ts>(N), ...);
+		}
+
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RestoreSnapshot
+	// FullName:  Archetype::RestoreSnapshot
+	// Access:    public
+	// Returns:   void
+	// Description: Destroy every live row and read the chunks back. Chunks are never released,
+	//		the ones allocated after the snapshot was taken stay around empty
+	// Parameter: SnapshotReader & reader
+	void RestoreSnapshot(SnapshotReader& reader) override
+	{
+		const uint32_t chunkCount = reader.ReadValue<uint32_t>();
+
+		if (chunkCount > m_Chunks.size())
+			throw std::exception("Snapshot has more archetype chunks than the archetype, it belongs to another world");
+
+		for (auto pChunk : m_Chunks)
+		{
+			for (uint32_t i = 0; i < N; ++i)
+				DestroyRow(pChunk, i, pChunk->rowMask[i]);
+		}
+
+		m_ActiveCount = reader.ReadValue<uint32_t>();
+
+		// Rows of the empty chunks go under the restored ones, they get handed out in the same
+		//  order as chunks pushed after the snapshot would hand them out
+		std::vector<uint32_t> freeRows{};
+		reader.ReadPaddedVector(freeRows, chunkCount * N);
+		m_FreeRows.clear();
+
+		for (uint32_t chunk = static_cast<uint32_t>(m_Chunks.size()); chunk > chunkCount; --chunk)
+		{
+			for (uint32_t i = N; i > 0; --i)
+				m_FreeRows.push_back((chunk - 1U) * N + i - 1U);
+		}
+
+		m_FreeRows.insert(m_FreeRows.end(), freeRows.begin(), freeRows.end());
+
+		for (uint32_t chunk = 0U; chunk < m_Chunks.size(); ++chunk)
+		{
+			auto pChunk = m_Chunks[chunk];
+
+			if (chunk >= chunkCount)
+			{
+				std::fill(std::begin(pChunk->rowMask), std::end(pChunk->rowMask), 0U);
+				std::fill(std::begin(pChunk->rowReserved), std::end(pChunk->rowReserved), false);
+				pChunk->activeCount = 0U;
+				continue;
+			}
+
+			reader.Read(pChunk->rowMask, sizeof(pChunk->rowMask));
+			reader.Read(pChunk->rowReserved, sizeof(pChunk->rowReserved));
+			pChunk->activeCount = reader.ReadValue<uint32_t>();
+
+			(reader.ReadColumn(std::get<Ts*>(pChunk->columns), N, [pChunk](uint32_t i) { return (pChunk->rowMask[i] & BitOf<Ts>) != 0U; }), ...);
+		}
+	}
+
+	void ImGuiDebugUi() override
+	{
+#ifdef DEBUG_POOL
+		ImGui::Text("Chunks: %d, rows: %d / %d",
+			static_cast<int>(m_Chunks.size()),
+			static_cast<int>(m_ActiveCount),
+			static_cast<int>(m_Chunks.size() * N));
+#endif // DEBUG_POOL
+	}
+
+private:
+	template<typename T>
+	void ForEachColumnChunk(const std::function<void(const ArchetypeColumn&)>& f)
+	{
+		for (auto pChunk : m_Chunks)
+		{
+			if (pChunk->activeCount != 0U)
+				f({ std::get<T*>(pChunk->columns), pChunk->rowMask, BitOf<T>, N });
+		}
+	}
+
+	void PushChunk()
+	{
+		// Columns on cache lines like pool blocks, the ForEach loops run over them
+		auto pChunk = new (NewPoolBlock<Chunk>(1U)) Chunk();
+		pChunk->columns = std::make_tuple(NewPoolBlock<Ts>(N)...);
+
+		const auto base = static_cast<uint32_t>(m_Chunks.size()) * N;
+		m_Chunks.push_back(pChunk);
+
+		// Push in reverse so the lowest row gets handed out first
+		for (uint32_t i = N; i > 0; --i)
+			m_FreeRows.push_back(base + i - 1);
+	}
+
+	static void DestroyRow(Chunk* pChunk, uint32_t local, ColumnMask mask)
+	{
+		((mask & BitOf<Ts> ? (std::get<Ts*>(pChunk->columns)[local].~Ts(), 0) : 0), ...);
+	}
+
+	std::vector<Chunk*> m_Chunks;
+	std::vector<uint32_t> m_FreeRows;
+	uint32_t m_ActiveCount = 0U;
+};
+
+};
+
+#endif // !ARCHETYPE_H
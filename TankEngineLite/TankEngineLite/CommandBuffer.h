@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////
+// commandbuffer.h: Deferred structural changes of a world, recorded from any
+//		thread while the systems update and applied at the world's sync point
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace ECS
+{
+
+class Entity;
+
+//////////////////////////////////////////////////////////////////////////
+// Enum: CommandType
+// Description: What a deferred command does, applied in this order at the sync point.
+//		Batches are applied along side the creations, they create their own entities
+enum class CommandType : uint8_t { MODIFY, DESTROY, CREATE, SPAWN_BATCH };
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: EntityCommand
+// Description: A single deferred change. The key orders commands independently of 
+//		which thread recorded them, see CommandScope
+struct EntityCommand
+{
+	uint64_t key;
+	uint32_t entity;
+	CommandType type;
+	std::function<void(Entity*)> func;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: CommandScope
+// Description: Marks the calling thread as running the given system and pool range,
+//		commands recorded in the scope get keyed on that plus their order in the scope.
+//		Every range is run by exactly one thread, so the keys are the same no matter how the work got spread.
+//		Scopes nest, a thread helping out with other jobs while it waits restores its own scope afterwards
+class CommandScope
+{
+public:
+	CommandScope(uint32_t systemId, uint32_t range)
+		: m_PreviousContext(s_Context)
+		, m_PreviousSequence(s_Sequence)
+	{
+		s_Context = (static_cast<uint64_t>(systemId + 1U) << 48) | (static_cast<uint64_t>(range & 0xFFFFU) << 32);
+		s_Sequence = 0U;
+	}
+
+	~CommandScope()
+	{
+		s_Context = m_PreviousContext;
+		s_Sequence = m_PreviousSequence;
+	}
+
+	RO5(CommandScope);
+
+	// Key of the next command recorded on this thread, commands outside of any system come first
+	[[nodiscard]] static inline uint64_t NextKey() noexcept { return s_Context | s_Sequence++; }
+
+private:
+	uint64_t m_PreviousContext;
+	uint32_t m_PreviousSequence;
+
+	inline static thread_local uint64_t s_Context = 0U;
+	inline static thread_local uint32_t s_Sequence = 0U;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: CommandBuffer
+// Description: Commands recorded by one thread, the world keeps one per thread so recording never locks
+class CommandBuffer
+{
+public:
+	inline void Create(std::function<void(Entity*)> initializer)
+	{
+		m_Commands.push_back({ CommandScope::NextKey(), 0U, CommandType::CREATE, std::move(initializer) });
+	}
+
+	inline void SpawnBatch(std::function<void(Entity*)> spawner)
+	{
+		m_Commands.push_back({ CommandScope::NextKey(), 0U, CommandType::SPAWN_BATCH, std::move(spawner) });
+	}
+
+	inline void Destroy(uint32_t id)
+	{
+		m_Commands.push_back({ CommandScope::NextKey(), id, CommandType::DESTROY, nullptr });
+	}
+
+	inline void Modify(uint32_t id, std::function<void(Entity*)> func)
+	{
+		m_Commands.push_back({ CommandScope::NextKey(), id, CommandType::MODIFY, std::move(func) });
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    MoveTo
+	// FullName:  ECS::CommandBuffer::MoveTo
+	// Access:    public
+	// Returns:   void
+	// Description: Append all recorded commands to the given list and clear the buffer
+	// Parameter: std::vector<EntityCommand> & commands
+	inline void MoveTo(std::vector<EntityCommand>& commands)
+	{
+		std::move(m_Commands.begin(), m_Commands.end(), std::back_inserter(commands));
+		m_Commands.clear();
+	}
+
+	inline void Clear() { m_Commands.clear(); }
+
+	[[nodiscard]] inline auto GetCommandCount() const noexcept -> size_t { return m_Commands.size(); }
+
+private:
+	std::vector<EntityCommand> m_Commands;
+};
+
+};
+
+#endif // !COMMAND_BUFFER_H
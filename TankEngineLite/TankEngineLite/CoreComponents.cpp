@@ -53,18 +53,44 @@ void CameraComponent::GenerateViewMatrix()
 	auto V_up = XMVectorSet(0.f, 1.f, 0.f, 0.f);
 	auto V_lookAt = XMVectorSet(0.f, 0.f, 1.f, 0.f);
 
-	auto rotationMatrix = XMMatrixRotationQuaternion(XMLoadFloat4(&m_pEntityTransform->rotationQ));
+	// World position and rotation, so a camera attached to something follows it
+	XMVECTOR worldScale{}, worldRotation{}, transformPosition{};
+	XMMatrixDecompose(&worldScale, &worldRotation, &transformPosition, XMLoadFloat4x4(&m_pEntityTransform->GetWorldMatrix()));
+
+	auto rotationMatrix = XMMatrixRotationQuaternion(worldRotation);
 	rotationMatrix = XMMatrixTranspose(rotationMatrix);
 
 	V_lookAt = XMVector3TransformCoord(V_lookAt, rotationMatrix);
 	V_up = XMVector3TransformCoord(V_up, rotationMatrix);
 
-	const auto transformPosition = XMLoadFloat3(&m_pEntityTransform->position);
-
 	V_lookAt = transformPosition + V_lookAt;
 	XMStoreFloat4x4(&m_ViewMatrix, XMMatrixLookAtLH(transformPosition, V_lookAt, V_up));
 }
 
+void HierarchyComponent::SetParent(ECS::Entity* pParent)
+{
+	// Walk up from the new parent, running in to this entity means it would become its own ancestor
+	for (auto pAncestor = pParent; pAncestor != nullptr; )
+	{
+		if (pAncestor == m_pOwner)
+			throw std::exception("An entity can't be parented to itself or one of its children");
+
+		const auto pHierarchy = pAncestor->GetComponent<HierarchyComponent>();
+		pAncestor = (pHierarchy) ? pHierarchy->GetParent() : nullptr;
+	}
+
+	m_ParentId = (pParent) ? pParent->GetId() : NO_PARENT;
+	MarkChanged();
+}
+
+ECS::Entity* HierarchyComponent::GetParent() const
+{
+	if (m_ParentId == NO_PARENT)
+		return nullptr;
+
+	return m_pOwner->GetWorld()->GetEntity(m_ParentId);
+}
+
 ModelRenderComponent::ModelRenderComponent(ECS::Entity* pE)
 	: ECS::EntityComponent(pE)
 {
@@ -115,6 +141,7 @@ void ModelRenderComponent::Render()
 	// Shader render
 	pDeviceContext->IASetInputLayout(m_pEffect->GetInputLayout());
 
+	// Cached by the TransformSystem, only recomputed when the transform or one of its parents changed
 	XMFLOAT4X4 world = m_pTransform->GetWorldMatrix();
 	auto worldMat = XMLoadFloat4x4(&world);
 
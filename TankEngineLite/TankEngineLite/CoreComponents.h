@@ -17,6 +17,7 @@ class Model;
 class Effect;
 class Texture;
 class SpriteBatch;
+class SceneGraph;
 
 using namespace DirectX;
 
@@ -29,9 +30,10 @@ public:
 		return (start + percent * (end - start));
 	}
 
-	static int RandInterval(int min, int max)
+	// Draws from the given generator instead of rand(), pass World::GetRandom() for anything gameplay related
+	static int RandInterval(Random& random, int min, int max)
 	{
-		return min + rand() % (max + 1 - min);
+		return random.Interval(min, max);
 	}
 };
 
@@ -40,64 +42,166 @@ public:
 
 //////////////////////////////////////////////////////////////////////////
 // Component: TransformComponent
-// Description: Simple transform with a position, rotation and scale
+// Description: Simple transform with a position, rotation and scale. These are local to the parent
+//		when the entity has a HierarchyComponent, the world matrix is kept up to date by the TransformSystem
 class TransformComponent
 	: public ECS::EntityComponent
 {
+	friend class SceneGraph;
+
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	TransformComponent()
 		: position({ 0.f, 0.f, 0.f })
 		, scale({ 1.f, 1.f, 1.f })
+		, m_WorldTick(0U)
 	{
 		XMStoreFloat4(&rotationQ, XMQuaternionIdentity());
+		XMStoreFloat4x4(&m_WorldMatrix, XMMatrixIdentity());
 	}
 
 	TransformComponent(ECS::Entity* pE)
 		: ECS::EntityComponent(pE)
 		, position({ 0.f, 0.f, 0.f })
 		, scale({ 1.f, 1.f, 1.f })
+		, m_WorldTick(0U)
 	{ 
 		XMStoreFloat4(&rotationQ, XMQuaternionIdentity());
+		XMStoreFloat4x4(&m_WorldMatrix, XMMatrixIdentity());
 	}
 
 	~TransformComponent() { }
 
-	XMFLOAT4X4 GetWorldMatrix() const
+	// Position, rotation and scale as a matrix, relative to the parent
+	XMFLOAT4X4 GetLocalMatrix() const
 	{
-		XMFLOAT4X4 worldMatrix{};
+		XMFLOAT4X4 localMatrix{};
 		
 		auto rMat = XMMatrixRotationQuaternion(XMLoadFloat4(&rotationQ));
 		auto tMat = XMMatrixTranslation(position.x, position.y, position.z);
 		auto sMat = XMMatrixScaling(scale.x, scale.y, scale.z);
 
-		XMStoreFloat4x4(&worldMatrix, sMat * (rMat * tMat));
-		return worldMatrix;
+		XMStoreFloat4x4(&localMatrix, sMat * (rMat * tMat));
+		return localMatrix;
 	}
 
+	// Local to world as of the last TransformSystem update, changes made since show up after the next one
+	constexpr const XMFLOAT4X4& GetWorldMatrix() const noexcept { return m_WorldMatrix; }
+
+	// Tick the world matrix was last recomputed in, it changes when this transform or one of its parents does
+	[[nodiscard]] constexpr auto GetWorldTick() const noexcept -> uint32_t { return m_WorldTick; }
+	[[nodiscard]] constexpr auto IsWorldChangedSince(uint32_t tick) const noexcept -> bool { return m_WorldTick >= tick; }
+
 	void Translate(const XMFLOAT3& translation) 
 	{ 
 		XMStoreFloat3(&position, XMLoadFloat3(&translation) + XMLoadFloat3(&position));
+		MarkChanged();
 	}
 
 	void Rotate(float yaw, float pitch, float roll)
 	{
 		XMVECTOR rawRot = XMQuaternionRotationRollPitchYaw(pitch, yaw, roll);
 		XMStoreFloat4(&rotationQ, XMQuaternionMultiply(XMLoadFloat4(&rotationQ), rawRot));
+		MarkChanged();
 	}
 
 public:
+	// Call MarkChanged after writing to these directly, the TransformSystem only picks up marked changes
 	XMFLOAT3 position;
 	XMFLOAT3 scale;
 	XMFLOAT4 rotationQ;
+
+private:
+	XMFLOAT4X4 m_WorldMatrix;
+	uint32_t m_WorldTick;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Component: HierarchyComponent
+// Description: Attaches the TransformComponent of the entity to the one of a parent entity, position,
+//		rotation and scale are then relative to the parent. The parent is held by id, when it gets destroyed
+//		the entity becomes a root again. Needs a TransformComponent and a TransformSystem to have any effect
+class HierarchyComponent
+	: public ECS::EntityComponent
+{
+	friend class SceneGraph;
+
+public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
+	// Parent id of a root
+	static constexpr uint32_t NO_PARENT = ~0U;
+
+	HierarchyComponent()
+		: m_pTransform(nullptr)
+		, m_ParentId(NO_PARENT)
+		, m_SortedParentId(UNSORTED)
+		, m_Depth(0U)
+	{
+	}
+
+	HierarchyComponent(ECS::Entity* pE)
+		: ECS::EntityComponent(pE)
+		, m_ParentId(NO_PARENT)
+		, m_SortedParentId(UNSORTED)
+		, m_Depth(0U)
+	{
+		m_pTransform = pE->GetComponent<TransformComponent>();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetParent
+	// FullName:  HierarchyComponent::SetParent
+	// Access:    public 
+	// Returns:   void
+	// Description: Attach to pParent, nullptr detaches. Throws when pParent is this entity or one of its children,
+	//		the TransformSystem picks the new parent up on its next update
+	// Parameter: ECS::Entity * pParent
+	void SetParent(ECS::Entity* pParent);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetParent
+	// FullName:  HierarchyComponent::GetParent
+	// Access:    public 
+	// Returns:   ECS::Entity*
+	// Qualifier: const
+	// Description: The parent entity, nullptr for a root or when the parent is gone
+	[[nodiscard]] ECS::Entity* GetParent() const;
+
+	[[nodiscard]] constexpr auto GetParentId() const noexcept -> uint32_t { return m_ParentId; }
+
+	// Number of parents above this one, as of the last time the TransformSystem sorted the hierarchy
+	[[nodiscard]] constexpr auto GetDepth() const noexcept -> uint32_t { return m_Depth; }
+
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+	}
+
+private:
+	// Sorted parent of a component the SceneGraph hasn't seen yet
+	static constexpr uint32_t UNSORTED = NO_PARENT - 1U;
+
+	TransformComponent* m_pTransform;
+	uint32_t m_ParentId;
+	uint32_t m_SortedParentId; // Parent as of the last sort, a different one means it has to sort again
+	uint32_t m_Depth;
 };
 
 class CameraComponent
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<TransformComponent>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	CameraComponent()
 		: m_pEntityTransform(nullptr)
 		, m_ViewMatrix()
+		, m_ViewTick(0U)
 		, m_MeetsRequirements(false)
 	{
 	}
@@ -105,6 +209,7 @@ public:
 	CameraComponent(ECS::Entity* pE)
 		: ECS::EntityComponent(pE)
 		, m_ViewMatrix()
+		, m_ViewTick(0U)
 		, m_MeetsRequirements(false)
 	{
 		m_pEntityTransform = pE->GetComponent<TransformComponent>();
@@ -118,7 +223,15 @@ public:
 
 	void Update([[maybe_unused]] float dt) override
 	{
-		GenerateViewMatrix();
+		if (!m_MeetsRequirements)
+			return;
+
+		// Only when the world matrix changed since the last one, a change made later in the same tick still counts
+		if (m_pEntityTransform->IsWorldChangedSince(m_ViewTick))
+		{
+			GenerateViewMatrix();
+			m_ViewTick = m_pOwner->GetWorld()->GetChangeTick();
+		}
 	}
 
 	void GenerateViewMatrix();
@@ -126,9 +239,15 @@ public:
 	constexpr XMFLOAT4X4& GetViewMatrix() noexcept { return m_ViewMatrix; }
 	constexpr XMFLOAT3& GetPosition() const { return m_pEntityTransform->position; }
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pEntityTransform, pFrom, pTo);
+	}
+
 private:
 	TransformComponent* m_pEntityTransform;
 	XMFLOAT4X4 m_ViewMatrix;
+	uint32_t m_ViewTick;
 	bool m_MeetsRequirements;
 };
 
@@ -139,6 +258,9 @@ class TransformComponent2D
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	TransformComponent2D() 
 		: position({ 0.f, 0.f, 0.f })
 		, scale({ 1.f, 1.f })
@@ -171,6 +293,12 @@ class SpriteRenderComponent
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
+	// Owns the custom render function, snapshots copy the component instead of taking its bytes
+	static constexpr bool SnapshotByCopy = true;
+
 	SpriteRenderComponent()
 		: m_pTransform(nullptr)
 		, m_pSpriteBatch(nullptr)
@@ -246,6 +374,11 @@ public:
 	inline void ResetToDefault() { m_bShouldCustomRender = false; }
 	inline void SetEnabled(bool val) noexcept { m_Enabled = val; }
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+	}
+
 private:
 	TransformComponent2D* m_pTransform;
 	SpriteBatch* m_pSpriteBatch;
@@ -265,6 +398,9 @@ class ModelRenderComponent
 	: public ECS::EntityComponent
 {
 public:
+	using ReadSet = ECS::ComponentSet<>;
+	using WriteSet = ECS::ComponentSet<>;
+
 	ModelRenderComponent()
 		: m_pModel(nullptr)
 		, m_pTexture(nullptr)
@@ -286,6 +422,11 @@ public:
 	void Initialize(Model* pModel, Texture* pTexture);
 	void Render();
 
+	void OnComponentMoved(const ECS::EntityComponent* pFrom, ECS::EntityComponent* pTo) override
+	{
+		Repoint(m_pTransform, pFrom, pTo);
+	}
+
 private:
 	Model* m_pModel;
 	Texture* m_pTexture;
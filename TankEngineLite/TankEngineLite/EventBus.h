@@ -0,0 +1,201 @@
+//////////////////////////////////////////////////////////////////////////
+// eventbus.h: Typed events of a world, queued per event type from any thread
+//		while the systems update and handed to the subscribed systems in batch
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <vector>
+#include <mutex>
+
+#include "CommandBuffer.h"
+#include "ThreadPool.h"
+
+namespace ECS
+{
+
+class World;
+
+// Target of an event that isn't sent to a single entity
+constexpr uint32_t EVENT_NO_ENTITY = ~0U;
+
+// Tag of an event broadcast to every subscriber
+constexpr uint32_t EVENT_ALL_TAGS = ~0U;
+
+//////////////////////////////////////////////////////////////////////////
+// Class: EventTypeId
+// Description: Small dense id per event type, the world indexes its event queues with them
+class EventTypeId
+{
+public:
+	template<typename E>
+	[[nodiscard]] static uint32_t Get()
+	{
+		static const uint32_t id = s_Next.fetch_add(1U, std::memory_order_relaxed);
+		return id;
+	}
+
+private:
+	inline static std::atomic<uint32_t> s_Next{ 0U };
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: IsCoalescedEvent<typename E>
+// Description: True when the event declares `static constexpr bool Coalesce = true`,
+//		duplicates sent to the same entity or tag in one frame are delivered once, the first one wins
+template<typename E, typename = void>
+struct IsCoalescedEvent : std::false_type {};
+
+template<typename E>
+struct IsCoalescedEvent<E, std::void_t<decltype(E::Coalesce)>> : std::bool_constant<E::Coalesce> {};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: EventRecord<typename E>
+// Description: A queued event, either for one entity or for every subscriber on entities with the tag
+template<typename E>
+struct EventRecord
+{
+	uint64_t key;
+	uint32_t entity;
+	uint32_t tag;
+	E event;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: EventQueueBase
+// Description: Type erased interface the world drains its queues through
+class EventQueueBase
+{
+public:
+	virtual ~EventQueueBase() = default;
+
+	// Hand everything queued so far to the subscribers, main thread only
+	virtual void Dispatch(World* pWorld) = 0;
+	virtual size_t GetDeliveredCount() const = 0;
+
+	// Drop everything queued, main thread only
+	virtual void Clear() = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: EventQueue<typename E>
+// Description: Events of type E, every engine thread appends to its own list so sending never locks.
+//		Events are keyed like deferred commands (see CommandScope), the batch every subscriber gets
+//		is in the same order no matter which threads sent what
+template<typename E>
+class EventQueue final
+	: public EventQueueBase
+{
+public:
+	using Handler = void (*)(World*, const std::vector<EventRecord<E>>&);
+
+	EventQueue(uint32_t threadCount)
+		: m_ThreadEvents(threadCount)
+	{
+	}
+
+	RO5(EventQueue);
+
+	inline void Subscribe(Handler handler)
+	{
+		if (std::find(m_Handlers.begin(), m_Handlers.end(), handler) == m_Handlers.end())
+			m_Handlers.push_back(handler);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Push
+	// FullName:  ECS::EventQueue<E>::Push
+	// Access:    public
+	// Returns:   void
+	// Description: Queue an event, safe from any thread
+	// Parameter: uint32_t entity
+	// Parameter: uint32_t tag
+	// Parameter: const E & event
+	void Push(uint32_t entity, uint32_t tag, const E& event)
+	{
+		const uint32_t threadIndex = ThreadPool::GetThreadIndex();
+
+		if (threadIndex < m_ThreadEvents.size())
+		{
+			m_ThreadEvents[threadIndex].push_back({ CommandScope::NextKey(), entity, tag, event });
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		m_SharedEvents.push_back({ CommandScope::NextKey(), entity, tag, event });
+	}
+
+	void Dispatch(World* pWorld) override
+	{
+		m_Batch.clear();
+
+		for (auto& events : m_ThreadEvents)
+		{
+			std::move(events.begin(), events.end(), std::back_inserter(m_Batch));
+			events.clear();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_SharedMutex);
+			std::move(m_SharedEvents.begin(), m_SharedEvents.end(), std::back_inserter(m_Batch));
+			m_SharedEvents.clear();
+		}
+
+		std::stable_sort(m_Batch.begin(), m_Batch.end(), [](const EventRecord<E>& a, const EventRecord<E>& b) { return a.key < b.key; });
+
+		if constexpr (IsCoalescedEvent<E>::value)
+			Coalesce();
+
+		m_DeliveredCount = m_Batch.size();
+
+		if (m_Batch.empty())
+			return;
+
+		// Events sent from the handlers land in the per thread lists again, delivered next frame
+		for (auto handler : m_Handlers)
+			handler(pWorld, m_Batch);
+	}
+
+	[[nodiscard]] size_t GetDeliveredCount() const override { return m_DeliveredCount; }
+
+	void Clear() override
+	{
+		for (auto& events : m_ThreadEvents)
+			events.clear();
+
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		m_SharedEvents.clear();
+	}
+
+private:
+	// Keep the first event of every target, then back to key order
+	void Coalesce()
+	{
+		const auto SameTarget = [](const EventRecord<E>& a, const EventRecord<E>& b) { return a.entity == b.entity && a.tag == b.tag; };
+
+		std::stable_sort(m_Batch.begin(), m_Batch.end(), [](const EventRecord<E>& a, const EventRecord<E>& b)
+			{
+				return (a.entity != b.entity) ? a.entity < b.entity : a.tag < b.tag;
+			});
+
+		m_Batch.erase(std::unique(m_Batch.begin(), m_Batch.end(), SameTarget), m_Batch.end());
+		std::sort(m_Batch.begin(), m_Batch.end(), [](const EventRecord<E>& a, const EventRecord<E>& b) { return a.key < b.key; });
+	}
+
+	std::vector<std::vector<EventRecord<E>>> m_ThreadEvents;
+	std::vector<EventRecord<E>> m_SharedEvents;
+	std::mutex m_SharedMutex;
+
+	std::vector<EventRecord<E>> m_Batch;
+	std::vector<Handler> m_Handlers;
+	size_t m_DeliveredCount = 0U;
+};
+
+};
+
+#endif // !EVENT_BUS_H
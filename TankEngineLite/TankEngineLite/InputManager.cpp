@@ -4,6 +4,7 @@
 #include "imgui_impl_sdl.h"
 
 #include <vector>
+#include <cstring>
 #include <XInput.h>
 #include <algorithm>
 
@@ -166,6 +167,22 @@ bool InputManager::IsKeyDown(SDL_Scancode key)
 	return m_Keys[key];
 }
 
+InputFrame InputManager::GetFrame() const noexcept
+{
+	InputFrame frame;
+	std::memcpy(frame.keys, m_Keys, sizeof(m_Keys));
+	std::memcpy(frame.padKeys, m_PadKeys, sizeof(m_PadKeys));
+	std::memcpy(frame.controllerConnected, m_ControllerConnected, sizeof(m_ControllerConnected));
+	return frame;
+}
+
+void InputManager::SetFrame(const InputFrame& frame) noexcept
+{
+	std::memcpy(m_Keys, frame.keys, sizeof(m_Keys));
+	std::memcpy(m_PadKeys, frame.padKeys, sizeof(m_PadKeys));
+	std::memcpy(m_ControllerConnected, frame.controllerConnected, sizeof(m_ControllerConnected));
+}
+
 std::tuple<int, int, Uint32> InputManager::GetMouseState()
 {
 	int x, y;
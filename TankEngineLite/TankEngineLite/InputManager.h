@@ -109,6 +109,17 @@ struct RumblePack
 	uint32_t controller;
 };
 
+//////////////////////////////////////////////////////////////////////////
+// Struct: InputFrame
+// Description: Keyboard and gamepad state as the game sees it during a frame,
+//		what Simulation records per tick to replay them
+struct InputFrame
+{
+	bool keys[512];
+	bool padKeys[4][18];
+	bool controllerConnected[4];
+};
+
 //////////////////////////////////////////////////////////////////////////
 // Class: InputManager
 // Description: Input management handling, force feedback
@@ -233,6 +244,24 @@ public:
 	// Parameter: uint32_t controllerId
 	void RumbleController(unsigned short leftMotor, unsigned short rightMotor, float time, uint32_t controllerId = 0U);
 
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetFrame
+	// FullName:  InputManager::GetFrame
+	// Access:    public 
+	// Returns:   InputFrame
+	// Description: Current keyboard and gamepad state
+	[[nodiscard]] InputFrame GetFrame() const noexcept;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetFrame
+	// FullName:  InputManager::SetFrame
+	// Access:    public 
+	// Returns:   void
+	// Description: Overwrite the keyboard and gamepad state, IsKeyDown and IsPressed answer from it
+	//		until the next ProcessInput. Action mappings don't fire
+	// Parameter: const InputFrame & frame
+	void SetFrame(const InputFrame& frame) noexcept;
+
 private:
 	void SetControlerRumble(unsigned short leftMotor, unsigned short rightMotor, uint32_t controllerId = 0U);
 
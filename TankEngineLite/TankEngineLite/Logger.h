@@ -5,6 +5,7 @@
 #include "Singleton.h"
 
 #include <string>
+#include <mutex>
 #include <list>
 
 #define LOGGER Logger::GetInstance()
@@ -42,7 +43,7 @@ public:
 	// FullName:  Logger::Log<LogType loggerType, typename... T>
 	// Access:    public 
 	// Returns:   constexpr void
-	// Description: Log ...logs on to the engines logging system
+	// Description: Log ...logs on to the engines logging system, from any thread
 	// Parameter: const T & ... logs
 	template<LogType loggerType, typename... T>
 	constexpr void Log(const T& ... logs)
@@ -51,6 +52,8 @@ public:
 
 		// Unpack...
 		[[maybe_unused]] int u[]{ 0, (result += logs, 0)... };
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
 		m_Log.push_front(LogItem(result, loggerType));
 
 		// Remove one of the old items
@@ -80,6 +83,7 @@ public:
 		const char* items[5] = { "INFO", "SUCCESS", "WARNING", "ERROR", "ALL" };
 		ImGui::Combo("Log filter", &logType, items, IM_ARRAYSIZE(items));
 
+		std::lock_guard<std::mutex> lock(m_Mutex);
 		for (const auto& log : m_Log)
 		{
 			if (logType == 4)
@@ -98,6 +102,7 @@ public:
 private:
 	const uint32_t m_MaxLogSize = 64;
 	std::list<LogItem> m_Log;
+	std::mutex m_Mutex; // Worlds updating on workers log too
 };
 
 #endif // !LOGGER_H
\ No newline at end of file
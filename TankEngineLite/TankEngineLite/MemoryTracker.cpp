@@ -1,4 +1,5 @@
 #include "MemoryTracker.h"
 
 unsigned int Memory::m_TotalMemory = 0;
-std::unordered_map<void*, uint32_t> Memory::m_PointerPool{};
\ No newline at end of file
+std::unordered_map<void*, Memory::Allocation> Memory::m_PointerPool{};
+std::mutex Memory::m_Mutex{};
\ No newline at end of file
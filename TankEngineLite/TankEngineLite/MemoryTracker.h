@@ -2,10 +2,21 @@
 #define MEMORY_TRACKER_H
 
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include <mutex>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 // Struct: MemoryStatus
@@ -19,7 +30,8 @@ struct MemoryStatus
 //////////////////////////////////////////////////////////////////////////
 // Class: Memory
 // Description: Memory tracker, 
-//		perform allocations through this so that you can keep track of alive memory
+//		perform allocations through this so that you can keep track of alive memory.
+//		Safe from any thread, worlds allocate while they update on the workers
 class Memory
 {
 public:
@@ -31,23 +43,74 @@ public:
 	// Description: Allocate memory of size sizeof(T) * count
 	// Parameter: unsigned int count
 	template<typename T>
-	[[nodiscard]] constexpr static T* New(unsigned int count = 1U)
+	[[nodiscard]] static T* New(unsigned int count = 1U)
 	{
 		const auto size = sizeof(T);
 		auto pObj = static_cast<T*>(calloc(count, size));
 
 		if (pObj)
 		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
 			m_TotalMemory += size * count;
 
 			// Update pointer pool
-			m_PointerPool[static_cast<void*>(pObj)] = size * count;
+			m_PointerPool[static_cast<void*>(pObj)] = { static_cast<uint32_t>(size * count), AllocationKind::HEAP };
 			return pObj;
 		}
 
 		return nullptr;
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    NewAligned
+	// FullName:  Memory::NewAligned
+	// Access:    public static 
+	// Returns:   T*
+	// Description: Allocate zeroed memory of size sizeof(T) * count starting on an alignment boundary, like New.
+	//		The size is rounded up to a whole number of alignments so no other allocation shares its first or last cache line.
+	//		With hugePages, blocks of at least HUGE_PAGE_SIZE are mapped on their own and the kernel is asked to back them
+	//		with huge pages, Linux only, it's ignored everywhere else. Give it back with Delete like the rest
+	// Parameter: unsigned int count
+	// Parameter: size_t alignment, a power of two
+	// Parameter: bool hugePages
+	template<typename T>
+	[[nodiscard]] static T* NewAligned(unsigned int count, size_t alignment, bool hugePages = false)
+	{
+		alignment = (alignment < alignof(T)) ? alignof(T) : alignment;
+		size_t size = (sizeof(T) * count + alignment - 1U) / alignment * alignment;
+		void* pMemory = nullptr;
+		auto kind = AllocationKind::ALIGNED;
+
+#ifdef __linux__
+		if (hugePages && size >= HUGE_PAGE_SIZE)
+		{
+			size = (size + HUGE_PAGE_SIZE - 1U) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+			pMemory = MapHugePages(size);
+			kind = AllocationKind::MAPPED;
+		}
+#endif
+
+		if (pMemory == nullptr)
+		{
+#ifdef _MSC_VER
+			pMemory = _aligned_malloc(size, alignment);
+#else
+			pMemory = std::aligned_alloc(alignment, size);
+#endif
+			kind = AllocationKind::ALIGNED;
+
+			if (pMemory == nullptr)
+				return nullptr;
+
+			std::memset(pMemory, 0, size);
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_TotalMemory += static_cast<uint32_t>(size);
+		m_PointerPool[pMemory] = { static_cast<uint32_t>(size), kind };
+		return static_cast<T*>(pMemory);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    Delete
 	// FullName:  Memory::Delete
@@ -58,19 +121,31 @@ public:
 	// Parameter: T* obj
 	// Parameter: bool callDestructor
 	template<typename T>
-	constexpr static void Delete(T* pObj, bool callDestructor = true)
+	static void Delete(T* pObj, bool callDestructor = true)
 	{
-		const auto size = sizeof(T);
-		const auto it = m_PointerPool.find(static_cast<void*>(pObj));
+		bool isTracked = false;
+		Allocation allocation{};
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			const auto it = m_PointerPool.find(static_cast<void*>(pObj));
+
+			if (it != m_PointerPool.cend())
+			{
+				isTracked = true;
+				allocation = it->second;
+				m_TotalMemory -= allocation.size;
+				m_PointerPool.erase(it);
+			}
+		}
 
-		if (it != m_PointerPool.cend())
+		// Destructors free memory of their own, so outside of the lock
+		if (isTracked)
 		{
 			if(callDestructor)
 				pObj->~T();
 
-			free(pObj);
-			m_TotalMemory -= it->second;
-			m_PointerPool.erase(it);
+			Free(static_cast<void*>(pObj), allocation);
 		}
 		else
 			std::cout << "Memory address not allocated by this memory manager" << std::endl;
@@ -84,6 +159,7 @@ public:
 	// Qualifier: noexcept
 	[[nodiscard]] static bool HasLeaks() noexcept
 	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
 		return !m_PointerPool.empty();
 	}
 
@@ -95,14 +171,72 @@ public:
 	// Qualifier: noexcept
 	[[nodiscard]] static MemoryStatus GetMemoryStatus() noexcept
 	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
 		return { m_TotalMemory, (uint32_t)m_PointerPool.size() };
 	}
 
+	// Size of a huge page, NewAligned maps blocks at least this big on their own
+	static constexpr size_t HUGE_PAGE_SIZE = 2U * 1024U * 1024U;
+
 private:
+	// How an allocation has to be given back
+	enum class AllocationKind : uint8_t { HEAP, ALIGNED, MAPPED };
+
+	struct Allocation
+	{
+		uint32_t size;
+		AllocationKind kind;
+	};
+
+	static void Free(void* pMemory, const Allocation& allocation)
+	{
+		switch (allocation.kind)
+		{
+#ifdef _MSC_VER
+		case AllocationKind::ALIGNED:
+			_aligned_free(pMemory);
+			break;
+#endif
+#ifdef __linux__
+		case AllocationKind::MAPPED:
+			munmap(pMemory, allocation.size);
+			break;
+#endif
+		default:
+			free(pMemory);
+			break;
+		}
+	}
+
+#ifdef __linux__
+	// size bytes of zeroed memory on a huge page boundary, nullptr if it can't be mapped.
+	//  Mapping one huge page more than needed and cutting off both ends is the only way to get the boundary
+	static void* MapHugePages(size_t size) noexcept
+	{
+		void* pMapped = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (pMapped == MAP_FAILED)
+			return nullptr;
+
+		const auto mapped = reinterpret_cast<uintptr_t>(pMapped);
+		const auto aligned = (mapped + HUGE_PAGE_SIZE - 1U) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+		if (aligned != mapped)
+			munmap(pMapped, aligned - mapped);
+
+		munmap(reinterpret_cast<void*>(aligned + size), mapped + HUGE_PAGE_SIZE - aligned);
+
+		// Only a hint, without transparent huge pages it's ordinary memory
+		madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+		return reinterpret_cast<void*>(aligned);
+	}
+#endif
+
 	static uint32_t m_TotalMemory;
 
 	// Keep track of a sized pointer
-	static std::unordered_map<void*, uint32_t> m_PointerPool;
+	static std::unordered_map<void*, Allocation> m_PointerPool;
+	static std::mutex m_Mutex;
 };
 
 #endif // !MEMORY_TRACKER_H
\ No newline at end of file
@@ -10,11 +10,26 @@
 #include <type_traits>
 #include <functional>
 #include <iostream>
+#include <cstring>
 #include <bitset>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // #define POOL_NO_THROW
 // Thank you DragonSlayer0531#3017 for the help with SFINAE
 
+// Pool blocks start on a POOL_ALIGNMENT boundary, a cache line unless defined otherwise.
+//  With POOL_HUGE_PAGES blocks of 2 MB and up get huge pages where the OS hands them out, see Memory::NewAligned
+#ifndef POOL_ALIGNMENT
+#define POOL_ALIGNMENT 64
+#endif
+// #define POOL_HUGE_PAGES
+
 #ifdef DEBUG_POOL
 #include <sstream>
 #include "imgui.h"
@@ -28,137 +43,524 @@ struct constexpr_mod
 };
 
 //////////////////////////////////////////////////////////////////////////
-// Class: Pool<typename T, uint32_s S>
-// Description: Memory pool container that generates a block of memory of sizeof(T) * S,
-//  to the user, the memory pool behaves as an T[S] array
-template<
-	typename T,
-	uint32_t S,
-	std::enable_if_t<constexpr_mod<S, 8>::value == 0, int> = 0
->
-class Pool
+// Struct: PoolBlock<typename T>
+// Description: One contiguous block of a pool, capacity objects and the look up bits saying which
+//		are in use. pUsedWords has a bit per 64 bit look up word with any bit set, see PoolBitmap.
+//		A Pool is a single block, a PagedPool one per page with a null pItems for released pages.
+//		pDenseCount is only set by a DensePool, its active objects are the first *pDenseCount
+template<typename T>
+struct PoolBlock
 {
-public:
-	Pool()
+	T* pItems;
+	char* pLookUp;
+	const uint64_t* pUsedWords;
+	const uint32_t* pDenseCount;
+	uint32_t capacity;
+};
+
+// Slot index of an object that isn't in the pool
+constexpr uint32_t POOL_NO_SLOT = ~0U;
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    PoolCountTrailingZeros
+// FullName:  PoolCountTrailingZeros
+// Access:    public 
+// Returns:   uint32_t
+// Description: Index of the lowest set bit, bits can't be 0. std::countr_zero is C++20
+// Parameter: uint64_t bits
+inline uint32_t PoolCountTrailingZeros(uint64_t bits) noexcept
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index = 0UL;
+	_BitScanForward64(&index, bits);
+	return static_cast<uint32_t>(index);
+#elif defined(_MSC_VER)
+	// x86 has no 64 bit scan, low half first
+	unsigned long index = 0UL;
+
+	if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+		return static_cast<uint32_t>(index);
+
+	_BitScanForward(&index, static_cast<unsigned long>(bits >> 32U));
+	return static_cast<uint32_t>(index) + 32U;
+#else
+	return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    NewPoolBlock
+// FullName:  NewPoolBlock<typename T>
+// Access:    public 
+// Returns:   T*
+// Description: Zeroed memory for count objects of a pool, aligned to POOL_ALIGNMENT and padded to a whole number of it
+//		so no other block or allocation shares a cache line with it. Give it back with Memory::Delete
+// Parameter: uint32_t count
+template<typename T>
+inline T* NewPoolBlock(uint32_t count)
+{
+#ifdef POOL_HUGE_PAGES
+	return Memory::NewAligned<T>(count, POOL_ALIGNMENT, true);
+#else
+	return Memory::NewAligned<T>(count, POOL_ALIGNMENT);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    PoolPrefetch
+// FullName:  PoolPrefetch
+// Access:    public 
+// Returns:   void
+// Description: Hint the cache to start loading the line at p, a no-op when the compiler has no way to say it
+// Parameter: const void * p
+inline void PoolPrefetch(const void* p) noexcept
+{
+#ifdef _MSC_VER
+	_mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+	__builtin_prefetch(p);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: PoolBitmap<uint32_t N>
+// Description: Look up bits of N slots as 64 bit words, plus two summaries with a bit per word, one for the words
+//		that still have a free slot and one for the words with any slot taken. Finding a free slot is a count trailing
+//		zeros on the summary and one on the word, a single summary word covers 4096 slots. Read as chars the words are the byte look up table the rest of the pool
+//		and the snapshots use, slot i is bit i % 8 of byte i / 8 (little endian, like every target of the engine)
+template<uint32_t N>
+struct PoolBitmap
+{
+	static constexpr uint32_t WORD_COUNT = (N + 63U) / 64U;
+	static constexpr uint32_t SUMMARY_COUNT = (WORD_COUNT + 63U) / 64U;
+
+	// Bits past slot N of the last word count as taken
+	static constexpr uint64_t PADDING = (N % 64U == 0U) ? 0ULL : ~((1ULL << (N % 64U)) - 1ULL);
+
+	uint64_t words[WORD_COUNT];
+	uint64_t openWords[SUMMARY_COUNT];
+	uint64_t usedWords[SUMMARY_COUNT];
+
+	// Every slot free
+	void Clear() noexcept
 	{
-		m_pPool = Memory::New<T>(S);
-		m_pLookUp = &m_LookUpInternal[0];
-		m_ActiveCount = 0;
+		std::memset(words, 0, sizeof(words));
+		Summarize();
 	}
 
-	~Pool()
+	// Rebuild the summary after the words were written to directly
+	void Summarize() noexcept
 	{
-		// Call destructor on the still active pool elements, 
-		//  We don't want to deallocate just yet
-		ForAllActive([](T* pObj) { pObj->~T(); });
+		std::memset(openWords, 0, sizeof(openWords));
+		std::memset(usedWords, 0, sizeof(usedWords));
 
-		// Free the memory block 
-		Memory::Delete(m_pPool, false);
+		for (uint32_t word = 0U; word < WORD_COUNT; ++word)
+			UpdateSummary(word);
+	}
+
+	[[nodiscard]] inline char* GetLookUp() noexcept { return reinterpret_cast<char*>(words); }
+
+	[[nodiscard]] inline bool IsSet(uint32_t index) const noexcept { return (words[index / 64U] >> (index % 64U)) & 1ULL; }
+
+	// Lowest free slot, POOL_NO_SLOT when all of them are taken
+	[[nodiscard]] inline uint32_t FindFree() const noexcept
+	{
+		for (uint32_t summary = 0U; summary < SUMMARY_COUNT; ++summary)
+		{
+			if (openWords[summary] == 0ULL)
+				continue;
+
+			const uint32_t word = summary * 64U + PoolCountTrailingZeros(openWords[summary]);
+			return word * 64U + PoolCountTrailingZeros(~(words[word] | Padding(word)));
+		}
+
+		return POOL_NO_SLOT;
+	}
+
+	inline void Set(uint32_t index) noexcept
+	{
+		words[index / 64U] |= 1ULL << (index % 64U);
+		UpdateSummary(index / 64U);
+	}
+
+	inline void Reset(uint32_t index) noexcept
+	{
+		words[index / 64U] &= ~(1ULL << (index % 64U));
+		openWords[index / 4096U] |= 1ULL << ((index / 64U) % 64U);
+
+		if (words[index / 64U] == 0ULL)
+			usedWords[index / 4096U] &= ~(1ULL << ((index / 64U) % 64U));
+	}
+
+	inline void Flip(uint32_t index) noexcept
+	{
+		words[index / 64U] ^= 1ULL << (index % 64U);
+		UpdateSummary(index / 64U);
+	}
+
+private:
+	static constexpr uint64_t Padding(uint32_t word) noexcept { return (word == WORD_COUNT - 1U) ? PADDING : 0ULL; }
+
+	inline void UpdateSummary(uint32_t word) noexcept
+	{
+		const uint64_t flag = 1ULL << (word % 64U);
+
+		if ((words[word] | Padding(word)) == ~0ULL)
+			openWords[word / 64U] &= ~flag;
+		else
+			openWords[word / 64U] |= flag;
+
+		if (words[word] == 0ULL)
+			usedWords[word / 64U] &= ~flag;
+		else
+			usedWords[word / 64U] |= flag;
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    ForAllActiveInBlock
+// FullName:  ForAllActiveInBlock<typename T, typename F>
+// Access:    public 
+// Returns:   void
+// Description: For all active objects of a block with a slot index in [begin, end), in slot order, f(pObj).
+//		Goes from one set look up bit to the next a 64 bit word at a time, words with nothing active are skipped
+//		through pUsedWords so a sparse block costs about what its active objects do. The next active object is
+//		prefetched while f runs on the current one. f can pop objects, the ones further on in the block aren't
+//		visited anymore, objects pushed during the loop may or may not be.
+//		Dense blocks skip the look up bits and go from the last active object to the first, f can pop the one it got
+// Parameter: PoolBlock<T> block
+// Parameter: uint32_t begin
+// Parameter: uint32_t end
+// Parameter: F&& f
+template<typename T, typename F>
+inline void ForAllActiveInBlock(PoolBlock<T> block, uint32_t begin, uint32_t end, F&& f)
+{
+	if (block.pItems == nullptr || begin >= end)
+		return;
+
+	if (block.pDenseCount != nullptr)
+	{
+		// Popping moves the last object in to the hole, that one was visited already
+		for (uint32_t index = (end < *block.pDenseCount) ? end : *block.pDenseCount; index > begin; --index)
+		{
+			if (index <= *block.pDenseCount)
+				f(&block.pItems[index - 1U]);
+		}
+
+		return;
+	}
+
+	const auto pWords = reinterpret_cast<const uint64_t*>(block.pLookUp);
+	const uint32_t firstWord = begin / 64U;
+	const uint32_t endWord = (end + 63U) / 64U;
+
+	// Bits from lo up to but not including hi, both in [0, 64]
+	const auto bitRange = [](uint32_t lo, uint32_t hi) -> uint64_t
+	{
+		const uint64_t below = (hi == 64U) ? ~0ULL : (1ULL << hi) - 1ULL;
+		return (lo == 64U) ? 0ULL : below & ~((1ULL << lo) - 1ULL);
+	};
+
+	for (uint32_t summary = firstWord / 64U; summary * 64U < endWord; ++summary)
+	{
+		const uint32_t wordBase = summary * 64U;
+		uint64_t used = block.pUsedWords[summary] & bitRange(
+			(firstWord > wordBase) ? firstWord - wordBase : 0U,
+			(endWord < wordBase + 64U) ? endWord - wordBase : 64U);
+
+		while (used != 0ULL)
+		{
+			const uint32_t word = wordBase + PoolCountTrailingZeros(used);
+			used &= used - 1ULL;
+
+			const uint32_t itemBase = word * 64U;
+			uint64_t bits = pWords[word] & bitRange(
+				(begin > itemBase) ? begin - itemBase : 0U,
+				(end < itemBase + 64U) ? end - itemBase : 64U);
+
+			// Fully active, plain walk, the hardware prefetcher has it covered
+			if (bits == ~0ULL)
+			{
+				for (uint32_t bit = 0U; bit < 64U; ++bit)
+				{
+					if ((pWords[word] >> bit) & 1ULL)
+						f(&block.pItems[itemBase + bit]);
+				}
+
+				continue;
+			}
+
+			while (bits != 0ULL)
+			{
+				T* pItem = &block.pItems[itemBase + PoolCountTrailingZeros(bits)];
+				bits &= bits - 1ULL;
+
+				if (bits != 0ULL)
+					PoolPrefetch(&block.pItems[itemBase + PoolCountTrailingZeros(bits)]);
+
+				f(pItem);
+
+				// Drop what f popped, never pick up what it pushed
+				bits &= pWords[word];
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    SwapPoolSlots
+// FullName:  SwapPoolSlots<typename T>
+// Access:    public 
+// Returns:   void
+// Description: Exchange the objects of two pool slots, either can be free. Objects are copy or move
+//		constructed in to their new slot and destroyed in the old one, the look up bits are the caller's
+// Parameter: T * pA
+// Parameter: bool isActiveA
+// Parameter: T * pB
+// Parameter: bool isActiveB
+template<typename T>
+inline void SwapPoolSlots(T* pA, bool isActiveA, T* pB, bool isActiveB)
+{
+	if (isActiveA && isActiveB)
+	{
+		T temp(std::move(*pA));
+		pA->~T();
+		new (pA) T(std::move(*pB));
+		pB->~T();
+		new (pB) T(std::move(temp));
+	}
+	else if (isActiveA)
+	{
+		new (pB) T(std::move(*pA));
+		pA->~T();
 	}
+	else if (isActiveB)
+	{
+		new (pA) T(std::move(*pB));
+		pB->~T();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Class: PoolBase<typename Derived, typename T, uint32_t B>
+// Description: Everything the pools hand out and look up the same way, on top of m_Blocks of B slots each.
+//		Block i holds the slots [i * B, (i + 1) * B). A pool only decides how slots are claimed and released:
+//		Derived::Reserve(count) makes room for count more objects, growing or counting them in if it has to,
+//		and says false when they don't fit. Derived::Take() then marks a free slot in use and returns it
+template<typename Derived, typename T, uint32_t B>
+class PoolBase
+{
+public:
+	// Slots per range when the pool gets iterated in parallel, 64 slots are one look up word and 64 * sizeof(T)
+	//  bytes of objects, always a whole number of cache lines. A block starts on one, so two ranges never share one
+	static constexpr uint32_t RANGE_SIZE = 64U;
 
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    GetAndInit
-	// FullName:  Pool::GetAndInit<typename INIT_TYPE>
+	// FullName:  PoolBase<Derived, T, B>::GetAndInit<typename INIT_TYPE>
 	// Access:    public 
-	// Returns:   constexpr T*
+	// Returns:   T*
 	// Description: Get and initialize an object from the pool
 	// Note: Using this in the specific use case of ECS to initialized the object with it's parent entity
 	// Parameter: INIT_TYPE* pParentObj
 	template <typename INIT_TYPE>
-	[[nodiscard]] constexpr T* GetAndInit(INIT_TYPE* pParentObj)
+	[[nodiscard]] T* GetAndInit(INIT_TYPE* pParentObj)
 	{
-		// Test if pool is full
-		if (m_ActiveCount + 1 > S)
-		{
-#ifndef POOL_NO_THROW
- 			throw std::exception("Pool is full!");
-#else
+		if (!HasRoom(1U))
 			return nullptr;
-#endif
-		}
-
-		char* pPoolLookUp = m_pLookUp;
-		for (int i = 0; i < S / 8; ++i)
-		{
-			// Check pool map for inactive entities
-			for (int j = 0; j < 8; ++j)
-			{
-				char flag = (1 << j);
 
-				// Check inverse byte against flag
-				if (~(*pPoolLookUp) & flag)
-				{
-					*pPoolLookUp |= flag;
-					m_ActiveCount++;
+		// Placement new to get an initialized object
+		T* pFreeObject = Self()->Take();
+		new (pFreeObject)T(pParentObj);
+		return pFreeObject;
+	}
 
-					// Placement if to get an initialized object
-					T* pFreeObject = &m_pPool[i * 8 + j];
-                    new (pFreeObject)T (pParentObj);
-					return pFreeObject;
-				}
-			}
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetAndInitBatch
+	// FullName:  PoolBase<Derived, T, B>::GetAndInitBatch<typename INIT_TYPE, typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Get and initialize count objects in the order GetAndInit would hand them out,
+	//		object i is initialized with ppParentObjs[i] and handed to f(i, pObj). Room for all of them
+	//		is made up front, throws before touching anything when there isn't
+	// Parameter: INIT_TYPE * const * ppParentObjs
+	// Parameter: uint32_t count
+	// Parameter: F&& f
+	template <typename INIT_TYPE, typename F>
+	void GetAndInitBatch(INIT_TYPE* const* ppParentObjs, uint32_t count, F&& f)
+	{
+		if (!HasRoom(count))
+			return;
 
-			pPoolLookUp++;
+		for (uint32_t done = 0U; done < count; ++done)
+		{
+			T* pFreeObject = Self()->Take();
+			new (pFreeObject)T(ppParentObjs[done]);
+			f(done, pFreeObject);
 		}
-
-		// If allocation failed at this point, maybe some other thread added to the pool
-#ifndef POOL_NO_THROW
-		throw std::exception("Pool is full!");
-#else
-		return nullptr;
-#endif
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    Get
-	// FullName:  Pool<T, S>::Get
+	// FullName:  PoolBase<Derived, T, B>::Get
 	// Access:    public 
-	// Returns:   constexpr T*
+	// Returns:   T*
 	// Description: Get an available object from the pool
-	[[nodiscard]] constexpr T* Get()
+	[[nodiscard]] T* Get()
 	{
-		// Test if pool is full
-		if (m_ActiveCount + 1 > S)
-		{
-#ifndef POOL_NO_THROW
-			throw std::exception("Pool is full!");
-#else
+		if (!HasRoom(1U))
 			return nullptr;
-#endif
-		}
 
-		char* pPoolLookUp = m_pLookUp;
-		for (int i = 0; i < S / 8; ++i)
-		{
-			// Check pool map for inactive entities
-			for (int j = 0; j < 8; ++j)
-			{
-				char flag = (1 << j);
+		// Placement new to get an initialized object
+		T* pFreeObject = Self()->Take();
+		new (pFreeObject)T();
+		return pFreeObject;
+	}
 
-				// Check inverse byte against flag
-				if (~(*pPoolLookUp) & flag)
-				{
-					*pPoolLookUp |= flag;
-					m_ActiveCount++;
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForAllActive
+	// FullName:  PoolBase<Derived, T, B>::ForAllActive
+	// Access:    public 
+	// Returns:   void
+	// Description: For all active objects in the pool, block by block, f(pObj). A dense block goes last to first,
+	//		f can pop the object it got. f is a template parameter so lambdas get inlined in to the loop, see ForAllActiveInBlock
+	// Parameter: F&& f
+	template<typename F>
+	void ForAllActive(F&& f)
+	{
+		for (const auto& block : m_Blocks)
+			ForAllActiveInBlock(block, 0U, B, f);
+	}
 
-					// Placement if to get an initialized object
-					T* pFreeObject = &m_pPool[i * 8 + j];
-					new (pFreeObject)T();
-					return pFreeObject;
-				}
-			}
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForAllActiveInRange
+	// FullName:  PoolBase<Derived, T, B>::ForAllActiveInRange
+	// Access:    public 
+	// Returns:   void
+	// Description: For all active objects with a slot index in [begin, end), the range can't span blocks.
+	//		begin and end get rounded down to a multiple of 8 so ranges never share a look up byte
+	// Parameter: uint32_t begin
+	// Parameter: uint32_t end
+	// Parameter: F&& f
+	template<typename F>
+	void ForAllActiveInRange(uint32_t begin, uint32_t end, F&& f)
+	{
+		const uint32_t block = begin / B;
 
-			pPoolLookUp++;
+		if (block >= m_Blocks.size())
+			return;
+
+		begin = (begin - block * B) - begin % 8;
+		end = (end - block * B > B) ? B : (end - block * B) - end % 8;
+
+		ForAllActiveInBlock(m_Blocks[block], begin, end, f);
+	}
+
+	// Every block, released ones included, see PoolBlock
+	[[nodiscard]] inline auto GetBlocks() const noexcept -> const std::vector<PoolBlock<T>>& { return m_Blocks; }
+
+	// The first block, the whole pool for the pools that only have one
+	[[nodiscard]] inline auto GetPool() const noexcept -> T* { return m_Blocks[0].pItems; }
+	[[nodiscard]] inline auto GetLookUp() const noexcept -> char* { return m_Blocks[0].pLookUp; }
+
+	// Slot indices in use by blocks, released ones included
+	[[nodiscard]] inline auto GetSlotCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Blocks.size()) * B; }
+	[[nodiscard]] inline auto GetRangeCount() const noexcept -> uint32_t { return (GetSlotCount() + RANGE_SIZE - 1U) / RANGE_SIZE; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    IsActive
+	// FullName:  PoolBase<Derived, T, B>::IsActive
+	// Access:    public 
+	// Returns:   bool
+	// Qualifier: const noexcept
+	// Description: Is the slot at index in use
+	// Parameter: uint32_t index
+	[[nodiscard]] inline auto IsActive(uint32_t index) const noexcept -> bool
+	{
+		const auto& block = m_Blocks[index / B];
+		return block.pItems != nullptr && (block.pLookUp[(index % B) / 8] & (1 << (index % 8))) != 0;
+	}
+
+	// Slot of an object, POOL_NO_SLOT when it's not in this pool
+	[[nodiscard]] inline auto IndexOf(const T* pObj) const noexcept -> uint32_t
+	{
+		for (uint32_t block = 0U; block < m_Blocks.size(); ++block)
+		{
+			const auto pItems = m_Blocks[block].pItems;
+
+			if (pItems != nullptr && pObj >= pItems && pObj < pItems + B)
+				return block * B + static_cast<uint32_t>(pObj - pItems);
 		}
 
-		// If allocation failed at this point, maybe some other thread added to the pool
+		return POOL_NO_SLOT;
+	}
+
+	// Object in a slot, nullptr when the slot is free or its block was released
+	[[nodiscard]] inline auto GetActive(uint32_t index) const noexcept -> T*
+	{
+		return (index < GetSlotCount() && Self()->IsActive(index)) ? &m_Blocks[index / B].pItems[index % B] : nullptr;
+	}
+
+protected:
+	PoolBase() = default;
+	~PoolBase() = default;
+
+	std::vector<PoolBlock<T>> m_Blocks;
+
+private:
+	// Derived::Reserve, "Pool is full!" when it says no
+	bool HasRoom(uint32_t count)
+	{
+		if (Self()->Reserve(count))
+			return true;
+
 #ifndef POOL_NO_THROW
 		throw std::exception("Pool is full!");
 #else
-		return nullptr;
+		return false;
 #endif
 	}
 
+	inline Derived* Self() noexcept { return static_cast<Derived*>(this); }
+	inline const Derived* Self() const noexcept { return static_cast<const Derived*>(this); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Pool<typename T, uint32_s S>
+// Description: Memory pool container that generates a block of memory of sizeof(T) * S,
+//  to the user, the memory pool behaves as an T[S] array. Free slots are found through a PoolBitmap
+template<
+	typename T,
+	uint32_t S,
+	std::enable_if_t<constexpr_mod<S, 8>::value == 0, int> = 0
+>
+class Pool
+	: public PoolBase<Pool<T, S>, T, S>
+{
+	using Base = PoolBase<Pool<T, S>, T, S>;
+	friend Base;
+	using Base::m_Blocks;
+
+public:
+	Pool()
+	{
+		m_pPool = NewPoolBlock<T>(S);
+		m_LookUp.Clear();
+		m_pLookUp = m_LookUp.GetLookUp();
+		m_ActiveCount = 0;
+		m_Blocks.push_back({ m_pPool, m_pLookUp, m_LookUp.usedWords, nullptr, S });
+	}
+
+	~Pool()
+	{
+		// Call destructor on the still active pool elements, 
+		//  We don't want to deallocate just yet
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+
+		// Free the memory block 
+		Memory::Delete(m_pPool, false);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    Pop
 	// FullName:  Pool<T, S>::Pop
@@ -168,7 +570,7 @@ public:
 	// Parameter: T * pPop
 	void Pop(T* pPop)
 	{
-		if (pPop < m_pPool || pPop > m_pPool + S)
+		if (pPop < m_pPool || pPop >= m_pPool + S)
 		{
 #ifndef	POOL_NO_THROW
 			throw std::exception("Address out of bounds of pool!");
@@ -180,18 +582,13 @@ public:
 		// Get index inside pool
 		uint32_t index = static_cast<uint32_t>(pPop - m_pPool);
 
-		// Get box in look up table
-		char* pBox = &m_pLookUp[(index / 8) % S];
-		int boxOffset = index % 8;
-
 		// If item active
-		char flag = (1 << boxOffset);
-		if (*pBox & flag)
+		if (m_LookUp.IsSet(index))
 		{
 			// We manually call the destructor, we don't want to actually deallocate
 			m_pPool[index].~T();
 
-			*pBox ^= flag;
+			m_LookUp.Reset(index);
 			m_ActiveCount--;
 		}
 	}
@@ -204,20 +601,41 @@ public:
 	// Description: Reset the pool to an empty state
 	void Reset()
 	{
-		for (int i = 0; i < (S / 8); ++i)
-			m_pLookUp[i] = 0;
-
+		m_LookUp.Clear();
 		m_ActiveCount = 0;
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Restore
+	// FullName:  Pool<T, S>::Restore<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Replace the whole content of the pool, the active objects get destroyed and the
+	//		look up table copied over. f(m_pPool) then has to bring every slot active in it back to life
+	// Parameter: const char * pLookUp
+	// Parameter: uint32_t activeCount
+	// Parameter: F&& f
+	template<typename F>
+	void Restore(const char* pLookUp, uint32_t activeCount, F&& f)
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+
+		std::memcpy(m_pLookUp, pLookUp, S / 8);
+		m_LookUp.Summarize();
+		m_ActiveCount = activeCount;
+
+		f(m_pPool);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    ForAll
 	// FullName:  Pool<T, S>::ForAll
 	// Access:    public 
 	// Returns:   void
 	// Description: For all active and inactive objects, f(pObj)
-	// Parameter: const std::function<void(T*)>& f
-	void ForAll()
+	// Parameter: F&& f
+	template<typename F>
+	void ForAll(F&& f)
 	{
 		T* pPoolItem = m_pPool;
 
@@ -228,75 +646,76 @@ public:
 		}
 	}
 
-	//************************************
-	// Method:    ForAllActive
-	// FullName:  Pool<T, S>::ForAllActive
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Swap
+	// FullName:  Pool<T, S>::Swap
 	// Access:    public 
-	// Returns:   void
-	// Description: For all active objects in the pool
-	// Parameter: const std::function<void(T*)>& f
-	void ForAllActive(const std::function<void(T*)>& f)
+	// Returns:   bool
+	// Description: Exchange the objects in slots a and b, either can be free. Pointers to the two
+	//		objects are left for the caller to fix, see SwapPoolSlots
+	// Parameter: uint32_t a
+	// Parameter: uint32_t b
+	bool Swap(uint32_t a, uint32_t b)
 	{
-		T* pPoolItem = m_pPool;
+		if (a >= S || b >= S || a == b)
+			return false;
 
-		for (int i = 0; i < S; ++i)
+		const bool isActiveA = this->IsActive(a);
+		const bool isActiveB = this->IsActive(b);
+		SwapPoolSlots(&m_pPool[a], isActiveA, &m_pPool[b], isActiveB);
+
+		if (isActiveA != isActiveB)
 		{
-			// Get box in look up table
-			char* pBox = &m_pLookUp[(i / 8) % S];
+			m_LookUp.Flip(a);
+			m_LookUp.Flip(b);
+		}
 
-#if 0 // This is broken, fix in ecs repo           
-			// If the box is 0, then no item is active
-			// TODO(tomas): unittest this
-			if (*pBox == 0)
-				continue;
-#endif
+		return true;
+	}
 
-			int boxOffset = i % 8;
+private:
+	inline bool Reserve(uint32_t count) const noexcept { return m_ActiveCount + count <= S; }
 
-			// If item active
-			char flag = (1 << boxOffset);
-			if (*pBox & flag)
-				f(pPoolItem);
+	// Lowest free slot, marked in use
+	T* Take()
+	{
+		const uint32_t index = m_LookUp.FindFree();
 
-			pPoolItem++;
+		if (index != POOL_NO_SLOT)
+		{
+			m_LookUp.Set(index);
+			m_ActiveCount++;
+			return &m_pPool[index];
 		}
+
+		// The active count said there was room
+#ifndef POOL_NO_THROW
+		throw std::exception("Pool is corrupt!");
+#else
+		return nullptr;
+#endif
 	}
 
-private:
 	T* m_pPool = nullptr;
-	char m_LookUpInternal[S / 8]{};
-	char* m_pLookUp = nullptr;
+	PoolBitmap<S> m_LookUp;
+	char* m_pLookUp = nullptr; // m_LookUp as bytes
 	uint32_t m_ActiveCount = 0U;
 
 public:
 
 	//////////////////////////////////////////////////////////////////////////
-	// Method:    GetPool
-	// FullName:  Pool<T, S>::GetPool
+	// Method:    GetActiveCount
+	// FullName:  Pool<T, S>::GetActiveCount
 	// Access:    public 
-	// Returns:   constexpr T*
-	// Qualifier: const noexcept
-	// Description: Get a pointer to the start of the pool
-	[[nodiscard]] constexpr auto GetPool() const noexcept -> T* { return m_pPool; }
-
-	//////////////////////////////////////////////////////////////////////////
-	// Method:    GetLookUp
-	// FullName:  Pool<T, S>::GetLookUp
-	// Access:    public 
-	// Returns:   constexpr char*
-	// Qualifier: const noexcept
-	// Description: Get a pointer to the start of the lookup bit table
-	[[nodiscard]] constexpr auto GetLookUp() const noexcept -> char* { return m_pLookUp; }
-
-	//////////////////////////////////////////////////////////////////////////
-	// Method:    GetActiveCount
-	// FullName:  Pool<T, S>::GetActiveCount
-	// Access:    public 
-	// Returns:   constexpr uint32_t
+	// Returns:   constexpr uint32_t
 	// Qualifier: const noexcept
 	// Description: Get active amount of items from the pool
 	[[nodiscard]] constexpr auto GetActiveCount() const noexcept -> uint32_t { return m_ActiveCount; }
 
+	// The whole pool is one block, see PoolBlock
+	[[nodiscard]] constexpr auto GetPageCount() const noexcept -> uint32_t { return 1U; }
+	[[nodiscard]] constexpr auto GetCapacity() const noexcept -> uint32_t { return S; }
+
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    ImGuiDebugUi
 	// FullName:  Pool<T, S>::ImGuiDebugUi
@@ -324,4 +743,816 @@ public:
 	}
 };
 
-#endif // !POOL_H
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////
+// Class: PagedPool<typename T, uint32_t P>
+// Description: Pool that grows a page of P objects at a time instead of throwing once it's full.
+//		Pages never move, so pointers to the objects stay valid, and the slot index of an object is
+//		page * P + its index in the page. Pages that end up empty are given back with Trim
+template<typename T, uint32_t P>
+class PagedPool
+	: public PoolBase<PagedPool<T, P>, T, P>
+{
+	static_assert(P > 0U && P % 64U == 0U, "Pages hold a whole number of 64 slot ranges");
+
+	using Base = PoolBase<PagedPool<T, P>, T, P>;
+	friend Base;
+	using Base::m_Blocks;
+
+public:
+	// A page is a whole number of ranges and starts on a cache line like a Pool block
+	static constexpr uint32_t PAGE_SIZE = P;
+
+	// The first page is there from the start, like the block of a Pool
+	PagedPool()
+	{
+		AddPage();
+	}
+
+	~PagedPool()
+	{
+		for (uint32_t page = 0U; page < m_Blocks.size(); ++page)
+			ReleasePage(page);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Pop
+	// FullName:  PagedPool<T, P>::Pop
+	// Access:    public 
+	// Returns:   void
+	// Description: Pop an object from the pool, its page stays allocated until the next Trim
+	// Parameter: T * pPop
+	void Pop(T* pPop)
+	{
+		for (uint32_t page = 0U; page < m_Blocks.size(); ++page)
+		{
+			const auto& block = m_Blocks[page];
+
+			if (block.pItems == nullptr || pPop < block.pItems || pPop >= block.pItems + P)
+				continue;
+
+			const uint32_t index = static_cast<uint32_t>(pPop - block.pItems);
+
+			if (m_Bitmaps[page]->IsSet(index))
+			{
+				// We manually call the destructor, we don't want to actually deallocate
+				pPop->~T();
+
+				m_Bitmaps[page]->Reset(index);
+				--m_PageActiveCounts[page];
+				--m_ActiveCount;
+				m_FirstOpenPage = (page < m_FirstOpenPage) ? page : m_FirstOpenPage;
+			}
+
+			return;
+		}
+
+#ifndef	POOL_NO_THROW
+		throw std::exception("Address out of bounds of pool!");
+#endif
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Trim
+	// FullName:  PagedPool<T, P>::Trim
+	// Access:    public 
+	// Returns:   uint32_t
+	// Description: Give the empty pages back to the allocator, returns how many. The first page stays.
+	//		Only call this when nothing is iterating the pool, the slots of a released page get reused by the next page added
+	uint32_t Trim()
+	{
+		uint32_t released = 0U;
+
+		for (uint32_t page = 1U; page < m_Blocks.size(); ++page)
+		{
+			if (m_Blocks[page].pItems != nullptr && m_PageActiveCounts[page] == 0U)
+			{
+				ReleasePage(page);
+				++released;
+			}
+		}
+
+		// Released pages at the end don't need a place in the list anymore
+		while (!m_Blocks.empty() && m_Blocks.back().pItems == nullptr)
+		{
+			m_Blocks.pop_back();
+			m_Bitmaps.pop_back();
+			m_PageActiveCounts.pop_back();
+		}
+
+		UpdateFirstOpenPage();
+		return released;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Clear
+	// FullName:  PagedPool<T, P>::Clear
+	// Access:    public 
+	// Returns:   void
+	// Description: Destroy every active object, the pages stay allocated
+	void Clear()
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+
+		for (uint32_t page = 0U; page < m_Blocks.size(); ++page)
+		{
+			if (m_Blocks[page].pItems != nullptr)
+				m_Bitmaps[page]->Clear();
+
+			m_PageActiveCounts[page] = 0U;
+		}
+
+		m_ActiveCount = 0U;
+		m_FirstOpenPage = 0U;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RestorePage
+	// FullName:  PagedPool<T, P>::RestorePage<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Counterpart of Pool::Restore for one page of a cleared pool, the look up bits are copied over
+	//		and f(pItems) has to bring every slot active in them back to life
+	// Parameter: uint32_t page
+	// Parameter: const char * pLookUp
+	// Parameter: F&& f
+	template<typename F>
+	void RestorePage(uint32_t page, const char* pLookUp, F&& f)
+	{
+		auto& block = m_Blocks[page];
+		std::memcpy(block.pLookUp, pLookUp, P / 8U);
+		m_Bitmaps[page]->Summarize();
+
+		uint32_t activeCount = 0U;
+		for (const uint64_t word : m_Bitmaps[page]->words)
+			activeCount += static_cast<uint32_t>(std::bitset<64>(word).count());
+
+		m_PageActiveCounts[page] = activeCount;
+		m_ActiveCount += activeCount;
+
+		f(block.pItems);
+		UpdateFirstOpenPage();
+	}
+
+	[[nodiscard]] constexpr auto GetActiveCount() const noexcept -> uint32_t { return m_ActiveCount; }
+	[[nodiscard]] constexpr auto GetPageCount() const noexcept -> uint32_t { return m_PageCount; }
+	[[nodiscard]] constexpr auto GetCapacity() const noexcept -> uint32_t { return m_PageCount * P; }
+	[[nodiscard]] inline auto GetPageActiveCount(uint32_t page) const noexcept -> uint32_t { return m_PageActiveCounts[page]; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Swap
+	// FullName:  PagedPool<T, P>::Swap
+	// Access:    public 
+	// Returns:   bool
+	// Description: Exchange the objects in slots a and b, either can be free but both pages have to be there.
+	//		Pointers to the two objects are left for the caller to fix, see SwapPoolSlots
+	// Parameter: uint32_t a
+	// Parameter: uint32_t b
+	bool Swap(uint32_t a, uint32_t b)
+	{
+		if (a >= this->GetSlotCount() || b >= this->GetSlotCount() || a == b)
+			return false;
+
+		const auto& blockA = m_Blocks[a / P];
+		const auto& blockB = m_Blocks[b / P];
+
+		if (blockA.pItems == nullptr || blockB.pItems == nullptr)
+			return false;
+
+		const bool isActiveA = this->IsActive(a);
+		const bool isActiveB = this->IsActive(b);
+		SwapPoolSlots(&blockA.pItems[a % P], isActiveA, &blockB.pItems[b % P], isActiveB);
+
+		if (isActiveA != isActiveB)
+		{
+			m_Bitmaps[a / P]->Flip(a % P);
+			m_Bitmaps[b / P]->Flip(b % P);
+
+			// The object went from the page of a to the one of b, or the other way around
+			const uint32_t from = (isActiveA) ? a / P : b / P;
+			const uint32_t to = (isActiveA) ? b / P : a / P;
+			--m_PageActiveCounts[from];
+			++m_PageActiveCounts[to];
+
+			m_FirstOpenPage = 0U;
+			UpdateFirstOpenPage();
+		}
+
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ImGuiDebugUi
+	// FullName:  PagedPool<T, P>::ImGuiDebugUi
+	// Access:    public 
+	// Returns:   void
+	// Description: Draw a Debug Card for this memory pool, one line per page
+	void ImGuiDebugUi()
+	{
+		std::stringstream stream;
+
+		for (uint32_t page = 0U; page < m_Blocks.size(); ++page)
+		{
+			stream << "Page " << page << ": ";
+
+			if (m_Blocks[page].pItems == nullptr)
+				stream << "released";
+			else
+				stream << m_PageActiveCounts[page] << " / " << P;
+
+			stream << std::endl;
+		}
+
+		ImGui::Text(stream.str().c_str());
+		ImGui::SameLine();
+	}
+
+private:
+	// The pages count more objects need on top of the free slots, a PagedPool never runs out
+	bool Reserve(uint32_t count)
+	{
+		while (GetCapacity() - m_ActiveCount < count)
+			AddPage();
+
+		return true;
+	}
+
+	// A free slot, Reserve made sure there is one
+	T* Take()
+	{
+		// Pages before the first open one are full, the bitmap of the first page with room has the slot
+		for (uint32_t page = m_FirstOpenPage; page < m_Blocks.size(); ++page)
+		{
+			if (m_Blocks[page].pItems == nullptr || m_PageActiveCounts[page] == P)
+				continue;
+
+			const uint32_t index = m_Bitmaps[page]->FindFree();
+
+			if (index != POOL_NO_SLOT)
+			{
+				m_Bitmaps[page]->Set(index);
+				++m_PageActiveCounts[page];
+				++m_ActiveCount;
+				UpdateFirstOpenPage();
+
+				return &m_Blocks[page].pItems[index];
+			}
+		}
+
+		// The counts said there was room
+#ifndef POOL_NO_THROW
+		throw std::exception("Pool is corrupt!");
+#else
+		return nullptr;
+#endif
+	}
+
+	// A new page, in the place of a released one if there is one
+	void AddPage()
+	{
+		uint32_t page = 0U;
+		while (page < m_Blocks.size() && m_Blocks[page].pItems != nullptr)
+			++page;
+
+		if (page == m_Blocks.size())
+		{
+			m_Blocks.push_back({ nullptr, nullptr, nullptr, nullptr, P });
+			m_Bitmaps.push_back(nullptr);
+			m_PageActiveCounts.push_back(0U);
+		}
+
+		m_Bitmaps[page] = Memory::New<PoolBitmap<P>>();
+		m_Bitmaps[page]->Clear();
+		m_Blocks[page] = { NewPoolBlock<T>(P), m_Bitmaps[page]->GetLookUp(), m_Bitmaps[page]->usedWords, nullptr, P };
+		m_PageActiveCounts[page] = 0U;
+		++m_PageCount;
+
+		m_FirstOpenPage = (page < m_FirstOpenPage) ? page : m_FirstOpenPage;
+	}
+
+	void ReleasePage(uint32_t page)
+	{
+		auto& block = m_Blocks[page];
+
+		if (block.pItems == nullptr)
+			return;
+
+		this->ForAllActiveInRange(page * P, page * P + P, [](T* pObj) { pObj->~T(); });
+
+		Memory::Delete(block.pItems, false);
+		Memory::Delete(m_Bitmaps[page], false);
+		m_Bitmaps[page] = nullptr;
+
+		m_ActiveCount -= m_PageActiveCounts[page];
+		m_PageActiveCounts[page] = 0U;
+		block = { nullptr, nullptr, nullptr, nullptr, P };
+		--m_PageCount;
+	}
+
+	inline void UpdateFirstOpenPage()
+	{
+		while (m_FirstOpenPage < m_Blocks.size() && (m_Blocks[m_FirstOpenPage].pItems == nullptr || m_PageActiveCounts[m_FirstOpenPage] == P))
+			++m_FirstOpenPage;
+	}
+
+	std::vector<PoolBitmap<P>*> m_Bitmaps; // Look up bits of every page, the blocks point in to them
+	std::vector<uint32_t> m_PageActiveCounts;
+	uint32_t m_PageCount = 0U;
+	uint32_t m_ActiveCount = 0U;
+
+	// No page before this one has a free slot
+	uint32_t m_FirstOpenPage = 0U;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: ConcurrentPool<typename T, uint32_t S>
+// Description: Pool of S objects that can be taken from and popped back to by several threads at once.
+//		The look up bits are atomic 64 bit words and a slot is claimed with a compare exchange on its word,
+//		with the same summary of open words as PoolBitmap to find one. Uncontended it hands out the lowest
+//		free slot like Pool, a thread that loses a race carries on from its own part of the pool so threads
+//		spawning at the same time stop fighting over the same word. The summary of used words only gets
+//		bits added while the pool is shared, iterating skips the words that were never used since the last Reset.
+//		Iterating, Swap, Reset and Restore still want the pool to themselves
+template<
+	typename T,
+	uint32_t S,
+	std::enable_if_t<constexpr_mod<S, 8>::value == 0, int> = 0
+>
+class ConcurrentPool
+	: public PoolBase<ConcurrentPool<T, S>, T, S>
+{
+	static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+		"The look up words are read as plain words by the snapshots and ForAllActiveInBlock");
+
+	static constexpr uint32_t WORD_COUNT = (S + 63U) / 64U;
+	static constexpr uint32_t SUMMARY_COUNT = (WORD_COUNT + 63U) / 64U;
+	static constexpr uint64_t PADDING = (S % 64U == 0U) ? 0ULL : ~((1ULL << (S % 64U)) - 1ULL);
+
+	using Base = PoolBase<ConcurrentPool<T, S>, T, S>;
+	friend Base;
+	using Base::m_Blocks;
+
+public:
+	// The look up words read as bytes are the look up table of the block, like a Pool's
+	ConcurrentPool()
+	{
+		m_pPool = NewPoolBlock<T>(S);
+		Summarize(nullptr);
+		m_Blocks.push_back({ m_pPool, reinterpret_cast<char*>(m_Words), reinterpret_cast<const uint64_t*>(m_UsedWords), nullptr, S });
+	}
+
+	~ConcurrentPool()
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+		Memory::Delete(m_pPool, false);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Pop
+	// FullName:  ConcurrentPool<T, S>::Pop
+	// Access:    public 
+	// Returns:   void
+	// Description: Pop an object from the pool, from any thread. The object is destroyed before its slot
+	//		is given back, popping the same object from two threads at once is still a bug
+	// Parameter: T * pPop
+	void Pop(T* pPop)
+	{
+		if (pPop < m_pPool || pPop >= m_pPool + S)
+		{
+#ifndef	POOL_NO_THROW
+			throw std::exception("Address out of bounds of pool!");
+#else
+			return;
+#endif
+		}
+
+		const uint32_t index = static_cast<uint32_t>(pPop - m_pPool);
+
+		if (!IsActive(index))
+			return;
+
+		// We manually call the destructor, we don't want to actually deallocate
+		pPop->~T();
+
+		const uint32_t word = index / 64U;
+		m_Words[word].fetch_and(~(1ULL << (index % 64U)));
+		m_OpenWords[word / 64U].fetch_or(1ULL << (word % 64U));
+
+		// Only now, a reservation always has a free bit behind it
+		m_ActiveCount.fetch_sub(1U);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Reset
+	// FullName:  ConcurrentPool<T, S>::Reset
+	// Access:    public 
+	// Returns:   void
+	// Description: Reset the pool to an empty state
+	void Reset()
+	{
+		Summarize(nullptr);
+		m_ActiveCount.store(0U);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Restore
+	// FullName:  ConcurrentPool<T, S>::Restore<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Same as Pool::Restore, the active objects get destroyed and the look up table
+	//		copied over. f(m_pPool) then has to bring every slot active in it back to life
+	// Parameter: const char * pLookUp
+	// Parameter: uint32_t activeCount
+	// Parameter: F&& f
+	template<typename F>
+	void Restore(const char* pLookUp, uint32_t activeCount, F&& f)
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+
+		Summarize(pLookUp);
+		m_ActiveCount.store(activeCount);
+
+		f(m_pPool);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Swap
+	// FullName:  ConcurrentPool<T, S>::Swap
+	// Access:    public 
+	// Returns:   bool
+	// Description: Exchange the objects in slots a and b like Pool::Swap, nothing else can be using the pool
+	// Parameter: uint32_t a
+	// Parameter: uint32_t b
+	bool Swap(uint32_t a, uint32_t b)
+	{
+		if (a >= S || b >= S || a == b)
+			return false;
+
+		const bool isActiveA = IsActive(a);
+		const bool isActiveB = IsActive(b);
+		SwapPoolSlots(&m_pPool[a], isActiveA, &m_pPool[b], isActiveB);
+
+		if (isActiveA != isActiveB)
+		{
+			for (const uint32_t index : { a, b })
+			{
+				const uint32_t word = index / 64U;
+				m_Words[word].fetch_xor(1ULL << (index % 64U));
+				m_OpenWords[word / 64U].fetch_or(1ULL << (word % 64U));
+				CloseIfFull(word);
+				MarkUsed(word);
+			}
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] inline auto GetActiveCount() const noexcept -> uint32_t { return m_ActiveCount.load(std::memory_order_relaxed); }
+
+	// The look up words are written by other threads, read them as atomics
+	[[nodiscard]] inline auto IsActive(uint32_t index) const noexcept -> bool { return (m_Words[index / 64U].load(std::memory_order_acquire) >> (index % 64U)) & 1ULL; }
+
+	// The whole pool is one block, see PoolBlock
+	[[nodiscard]] constexpr auto GetPageCount() const noexcept -> uint32_t { return 1U; }
+	[[nodiscard]] constexpr auto GetCapacity() const noexcept -> uint32_t { return S; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ImGuiDebugUi
+	// FullName:  ConcurrentPool<T, S>::ImGuiDebugUi
+	// Access:    public 
+	// Returns:   void
+	// Description: Draw a Debug Card for this memory pool, the look up words and how often a claim lost a race
+	void ImGuiDebugUi()
+	{
+		std::stringstream stream;
+		stream << "Lost claims: " << m_LostClaims.load(std::memory_order_relaxed) << std::endl;
+
+		for (uint32_t word = 0U; word < WORD_COUNT; ++word)
+		{
+			stream << std::bitset<64>(m_Words[word].load(std::memory_order_relaxed)) << " ";
+
+			if (word % 2U == 1U)
+				stream << std::endl;
+		}
+
+		ImGui::Text(stream.str().c_str());
+		ImGui::SameLine();
+	}
+
+private:
+	// Count count objects in before looking for their slots, false when they don't fit
+	bool Reserve(uint32_t count) noexcept
+	{
+		if (m_ActiveCount.fetch_add(count) + count <= S)
+			return true;
+
+		m_ActiveCount.fetch_sub(count);
+		return false;
+	}
+
+	// A free slot for an object that was reserved, there is one even if it takes a few tries to see it
+	T* Take()
+	{
+		uint32_t startWord = 0U;
+
+		while (true)
+		{
+			bool isContended = false;
+			const uint32_t index = TryClaim(startWord, isContended);
+
+			if (index != POOL_NO_SLOT)
+				return &m_pPool[index];
+
+			// Lost a race, try from this thread's own part of the pool
+			if (isContended)
+			{
+				m_LostClaims.fetch_add(1U, std::memory_order_relaxed);
+				startWord = GetThreadStartWord();
+			}
+		}
+	}
+
+	// Claim the lowest free slot from startWord on, wrapping around. POOL_NO_SLOT when none was seen
+	//  or another thread changed the word first, isContended says which
+	uint32_t TryClaim(uint32_t startWord, bool& isContended)
+	{
+		const uint32_t startSummary = startWord / 64U;
+
+		for (uint32_t pass = 0U; pass <= SUMMARY_COUNT; ++pass)
+		{
+			const uint32_t summary = (startSummary + pass) % SUMMARY_COUNT;
+			uint64_t open = m_OpenWords[summary].load();
+
+			// The start summary goes first from startWord on, and last for the words before it
+			if (pass == 0U)
+				open &= ~0ULL << (startWord % 64U);
+			else if (pass == SUMMARY_COUNT)
+				open &= (1ULL << (startWord % 64U)) - 1ULL;
+
+			while (open != 0ULL)
+			{
+				const uint32_t word = summary * 64U + PoolCountTrailingZeros(open);
+				open &= open - 1ULL;
+
+				uint64_t bits = m_Words[word].load();
+				const uint64_t free = ~(bits | Padding(word));
+
+				if (free == 0ULL)
+					continue;
+
+				const uint64_t flag = free & (~free + 1ULL);
+
+				if (!m_Words[word].compare_exchange_strong(bits, bits | flag))
+				{
+					isContended = true;
+					return POOL_NO_SLOT;
+				}
+
+				CloseIfFull(word);
+				MarkUsed(word);
+				return word * 64U + PoolCountTrailingZeros(flag);
+			}
+		}
+
+		return POOL_NO_SLOT;
+	}
+
+	// Clear the open bit of a full word. A pop can free a slot between the two, so the word is looked at
+	//  again after, either that sees the pop or the pop sets the open bit after this cleared it
+	inline void CloseIfFull(uint32_t word) noexcept
+	{
+		const uint64_t flag = 1ULL << (word % 64U);
+
+		if ((m_Words[word].load() | Padding(word)) != ~0ULL)
+			return;
+
+		m_OpenWords[word / 64U].fetch_and(~flag);
+
+		if ((m_Words[word].load() | Padding(word)) != ~0ULL)
+			m_OpenWords[word / 64U].fetch_or(flag);
+	}
+
+	inline void MarkUsed(uint32_t word) noexcept
+	{
+		const uint64_t flag = 1ULL << (word % 64U);
+
+		if ((m_UsedWords[word / 64U].load(std::memory_order_relaxed) & flag) == 0ULL)
+			m_UsedWords[word / 64U].fetch_or(flag);
+	}
+
+	// Words from pLookUp, or all free for a nullptr, and both summaries rebuilt from them
+	void Summarize(const char* pLookUp) noexcept
+	{
+		uint64_t words[WORD_COUNT] = {};
+
+		if (pLookUp != nullptr)
+			std::memcpy(words, pLookUp, S / 8U);
+
+		uint64_t open[SUMMARY_COUNT] = {};
+		uint64_t used[SUMMARY_COUNT] = {};
+
+		for (uint32_t word = 0U; word < WORD_COUNT; ++word)
+		{
+			m_Words[word].store(words[word]);
+
+			if ((words[word] | Padding(word)) != ~0ULL)
+				open[word / 64U] |= 1ULL << (word % 64U);
+
+			if (words[word] != 0ULL)
+				used[word / 64U] |= 1ULL << (word % 64U);
+		}
+
+		for (uint32_t summary = 0U; summary < SUMMARY_COUNT; ++summary)
+		{
+			m_OpenWords[summary].store(open[summary]);
+			m_UsedWords[summary].store(used[summary]);
+		}
+	}
+
+	// Where a thread that lost a claim looks next, spread over the pool by thread
+	static inline uint32_t GetThreadStartWord() noexcept
+	{
+		static thread_local const uint32_t s_Hash = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ULL >> 32U);
+		return s_Hash % WORD_COUNT;
+	}
+
+	static constexpr uint64_t Padding(uint32_t word) noexcept { return (word == WORD_COUNT - 1U) ? PADDING : 0ULL; }
+
+	T* m_pPool = nullptr;
+	std::atomic<uint64_t> m_Words[WORD_COUNT];
+	std::atomic<uint64_t> m_OpenWords[SUMMARY_COUNT]; // Bit per word that has a free slot
+	std::atomic<uint64_t> m_UsedWords[SUMMARY_COUNT]; // Bit per word that had a slot taken since the last Reset
+	std::atomic<uint32_t> m_ActiveCount{ 0U }; // Reserved slots included
+	std::atomic<uint32_t> m_LostClaims{ 0U };
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: DensePool<typename T, uint32_t S>
+// Description: Pool of S objects that keeps its active objects packed at the front. Popping moves the
+//		last object in to the hole, so iterating touches count objects and no look up bits, but objects move.
+//		Pop hands the move to f(pFrom, pTo) for whoever holds pointers to it, the look up bits are kept for the
+//		snapshots and are always the first count bits
+template<
+	typename T,
+	uint32_t S,
+	std::enable_if_t<constexpr_mod<S, 8>::value == 0, int> = 0
+>
+class DensePool
+	: public PoolBase<DensePool<T, S>, T, S>
+{
+	using Base = PoolBase<DensePool<T, S>, T, S>;
+	friend Base;
+	using Base::m_Blocks;
+
+public:
+	DensePool()
+	{
+		m_pPool = NewPoolBlock<T>(S);
+		m_LookUp.Clear();
+		m_pLookUp = m_LookUp.GetLookUp();
+		m_Blocks.push_back({ m_pPool, m_pLookUp, m_LookUp.usedWords, &m_ActiveCount, S });
+	}
+
+	~DensePool()
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+		Memory::Delete(m_pPool, false);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Pop
+	// FullName:  DensePool<T, S>::Pop<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Pop an object from the pool and move the last active object in to its place,
+	//		f(pFrom, pTo) gets called after the move with pFrom already destroyed
+	// Parameter: T * pPop
+	// Parameter: F&& f
+	template<typename F>
+	void Pop(T* pPop, F&& f)
+	{
+		if (pPop < m_pPool || pPop >= m_pPool + S)
+		{
+#ifndef	POOL_NO_THROW
+			throw std::exception("Address out of bounds of pool!");
+#else
+			return;
+#endif
+		}
+
+		const uint32_t index = static_cast<uint32_t>(pPop - m_pPool);
+
+		if (index >= m_ActiveCount)
+			return;
+
+		// We manually call the destructor, we don't want to actually deallocate
+		const uint32_t last = m_ActiveCount - 1U;
+		pPop->~T();
+
+		if (index != last)
+		{
+			new (pPop) T(std::move(m_pPool[last]));
+			m_pPool[last].~T();
+		}
+
+		m_LookUp.Reset(last);
+		--m_ActiveCount;
+
+		if (index != last)
+			f(&m_pPool[last], pPop);
+	}
+
+	// For when nothing points at the objects
+	void Pop(T* pPop)
+	{
+		Pop(pPop, [](const T*, T*) {});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Reset
+	// FullName:  DensePool<T, S>::Reset
+	// Access:    public 
+	// Returns:   void
+	// Description: Reset the pool to an empty state
+	void Reset()
+	{
+		m_LookUp.Clear();
+		m_ActiveCount = 0U;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Restore
+	// FullName:  DensePool<T, S>::Restore<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Same as Pool::Restore, the look up table has to come from a DensePool, it's the first activeCount bits
+	// Parameter: const char * pLookUp
+	// Parameter: uint32_t activeCount
+	// Parameter: F&& f
+	template<typename F>
+	void Restore(const char* pLookUp, uint32_t activeCount, F&& f)
+	{
+		this->ForAllActive([](T* pObj) { pObj->~T(); });
+
+		std::memcpy(m_pLookUp, pLookUp, S / 8);
+		m_LookUp.Summarize();
+		m_ActiveCount = activeCount;
+
+		f(m_pPool);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Swap
+	// FullName:  DensePool<T, S>::Swap
+	// Access:    public 
+	// Returns:   bool
+	// Description: Exchange the objects in slots a and b, both have to be active to keep the pool packed.
+	//		Pointers to the two objects are left for the caller to fix, see SwapPoolSlots
+	// Parameter: uint32_t a
+	// Parameter: uint32_t b
+	bool Swap(uint32_t a, uint32_t b)
+	{
+		if (a >= m_ActiveCount || b >= m_ActiveCount || a == b)
+			return false;
+
+		SwapPoolSlots(&m_pPool[a], true, &m_pPool[b], true);
+		return true;
+	}
+
+	[[nodiscard]] constexpr auto GetActiveCount() const noexcept -> uint32_t { return m_ActiveCount; }
+
+	// The active objects are the first m_ActiveCount, no need for the look up bits
+	[[nodiscard]] constexpr auto IsActive(uint32_t index) const noexcept -> bool { return index < m_ActiveCount; }
+
+	// The whole pool is one block, see PoolBlock
+	[[nodiscard]] constexpr auto GetPageCount() const noexcept -> uint32_t { return 1U; }
+	[[nodiscard]] constexpr auto GetCapacity() const noexcept -> uint32_t { return S; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ImGuiDebugUi
+	// FullName:  DensePool<T, S>::ImGuiDebugUi
+	// Access:    public 
+	// Returns:   void
+	// Description: Draw a Debug Card for this memory pool, how much of it is in use
+	void ImGuiDebugUi()
+	{
+		ImGui::Text("%u / %u packed", m_ActiveCount, S);
+		ImGui::SameLine();
+	}
+
+private:
+	inline bool Reserve(uint32_t count) const noexcept { return m_ActiveCount + count <= S; }
+
+	// The slot after the last active object, marked in use
+	inline T* Take() noexcept
+	{
+		m_LookUp.Set(m_ActiveCount);
+		return &m_pPool[m_ActiveCount++];
+	}
+
+	T* m_pPool = nullptr;
+	PoolBitmap<S> m_LookUp;
+	char* m_pLookUp = nullptr; // m_LookUp as bytes
+	uint32_t m_ActiveCount = 0U;
+};
+
+#endif // !POOL_H
@@ -5,14 +5,17 @@ void Profiler::BeginSession()
 	if (m_pMainSession)
 		Reset();
 
+	s_IsSessionThread = true;
+
 	// Initialize the main session with the ID of 0, time of 0, and now sub sessions
 	m_pMainSession = new(Memory::New<Session>()) Session(0U);
 	m_pCurrentSession = m_pMainSession;
+	m_UntrackedDepth = 0U;
 }
 
 void Profiler::EndSession()
 {
-	if (m_pCurrentSession != m_pMainSession)
+	if (m_pCurrentSession != m_pMainSession || m_UntrackedDepth > 0U)
 		throw std::exception("Session unwinding failed, a sub session was left open");
 
 	m_pMainSession->End();
@@ -13,6 +13,8 @@ using namespace std::chrono;
 
 #define PROFILING_ON
 #define MAX_SUBSSESSION_COUNT 10
+#define MAX_WORKER_REPORT_COUNT 64
+#define MAX_WORLD_REPORT_COUNT 16
 
 //////////////////////////////////////////////////////////////////////////
 // Enum: SessionId
@@ -143,6 +145,24 @@ struct Session
 	void Report(float totalTime, int depth = 0);
 };
 
+//////////////////////////////////////////////////////////////////////////
+// Struct: WorkerReport
+// Description: Time a worker thread spent running jobs and parked since the last report
+struct WorkerReport
+{
+	float busyTime;
+	float idleTime;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: WorldReport
+// Description: Time the last update of a world took and the engine thread it ran on
+struct WorldReport
+{
+	float updateTime;
+	uint32_t threadIndex;
+};
+
 //////////////////////////////////////////////////////////////////////////
 // Class: Profiler
 // Description: Contains all the functionality to profile code and report results
@@ -158,6 +178,11 @@ public:
 		: m_pMainSession(nullptr)
 		, m_pCurrentSession(nullptr)
 		, m_pReportSession(nullptr)
+		, m_WorkerReports()
+		, m_WorkerReportCount(0U)
+		, m_WorldReports()
+		, m_WorldReportCount(0U)
+		, m_UntrackedDepth(0U)
 	{
 	}
 
@@ -194,13 +219,22 @@ public:
 	// Access:    public 
 	// Returns:   void
 	// Description: Begin a sub session of the profiler, 
-	//		main session needs to be open
+	//		main session needs to be open. Past MAX_SUBSSESSION_COUNT the sub session and everything
+	//		under it isn't recorded, the time still counts towards the session it's in.
+	//		Code that runs many times a frame, like the fixed ticks of a Simulation, hits that.
+	//		Only the thread that began the session records, on other threads this does nothing
 	template<uint32_t sessionId>
 	inline void BeginSubSession()
 	{
 #ifdef PROFILING_ON 
-		if (m_pCurrentSession->subSessionCount >= MAX_SUBSSESSION_COUNT)
-			throw std::exception("MAX_SUBSSESSION_COUNT exceeded");
+		if (!s_IsSessionThread)
+			return;
+
+		if (m_UntrackedDepth > 0U || m_pCurrentSession->subSessionCount >= MAX_SUBSSESSION_COUNT)
+		{
+			++m_UntrackedDepth;
+			return;
+		}
 
 		// Create a sub session 
 		auto pSession = new(Memory::New<Session>()) Session(sessionId, m_pCurrentSession);
@@ -218,6 +252,15 @@ public:
 	inline void EndSubSession()
 	{
 #ifdef PROFILING_ON
+		if (!s_IsSessionThread)
+			return;
+
+		if (m_UntrackedDepth > 0U)
+		{
+			--m_UntrackedDepth;
+			return;
+		}
+
 		// Stop the timer on this session
 		m_pCurrentSession->End();
 
@@ -226,6 +269,46 @@ public:
 #endif
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RecordWorker
+	// FullName:  Profiler::RecordWorker
+	// Access:    public 
+	// Returns:   void
+	// Description: Store the busy and idle time of a worker thread, shown with the next report
+	// Parameter: uint32_t worker
+	// Parameter: float busyTime
+	// Parameter: float idleTime
+	inline void RecordWorker(uint32_t worker, float busyTime, float idleTime)
+	{
+		if (worker >= MAX_WORKER_REPORT_COUNT)
+			return;
+
+		m_WorkerReports[worker] = { busyTime, idleTime };
+
+		if (worker >= m_WorkerReportCount)
+			m_WorkerReportCount = worker + 1U;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RecordWorld
+	// FullName:  Profiler::RecordWorld
+	// Access:    public 
+	// Returns:   void
+	// Description: Store how long the update of a world took, shown with the next report
+	// Parameter: uint32_t world
+	// Parameter: float updateTime
+	// Parameter: uint32_t threadIndex
+	inline void RecordWorld(uint32_t world, float updateTime, uint32_t threadIndex)
+	{
+		if (world >= MAX_WORLD_REPORT_COUNT)
+			return;
+
+		m_WorldReports[world] = { updateTime, threadIndex };
+
+		if (world >= m_WorldReportCount)
+			m_WorldReportCount = world + 1U;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Method:    Report
 	// FullName:  Profiler::Report
@@ -256,6 +339,40 @@ public:
 
 			ImGui::Begin("Profiler");
 			m_pReportSession->Report(rootSessionTime);
+
+			if (m_WorldReportCount > 0U)
+			{
+				ImGui::Separator();
+
+				for (uint32_t i = 0U; i < m_WorldReportCount; ++i)
+				{
+					const auto& report = m_WorldReports[i];
+
+					ImGui::TextColored(ImVec4(0.f, 1.f, 1.f, 1.f), "WORLD %d %%= ", i);
+					ImGui::SameLine();
+
+					if (report.threadIndex == 0U)
+						ImGui::Text("%.1f (%.2fms, main thread)", PercentageOf(report.updateTime), report.updateTime * 1000.f);
+					else
+						ImGui::Text("%.1f (%.2fms, worker %u)", PercentageOf(report.updateTime), report.updateTime * 1000.f, report.threadIndex - 1U);
+				}
+			}
+
+			if (m_WorkerReportCount > 0U)
+			{
+				ImGui::Separator();
+
+				for (uint32_t i = 0U; i < m_WorkerReportCount; ++i)
+				{
+					const auto& report = m_WorkerReports[i];
+					const float total = report.busyTime + report.idleTime;
+
+					ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "WORKER %d busy %%= ", i);
+					ImGui::SameLine();
+					ImGui::Text("%.1f (%.2fms busy, %.2fms idle)", (total > 0.f) ? (report.busyTime * 100.f) / total : 0.f, report.busyTime * 1000.f, report.idleTime * 1000.f);
+				}
+			}
+
 			ImGui::End();
 
 			Memory::Delete(m_pReportSession);
@@ -270,6 +387,18 @@ private:
 	Session* m_pMainSession;
 	Session* m_pCurrentSession;
 	Session* m_pReportSession;
+
+	WorkerReport m_WorkerReports[MAX_WORKER_REPORT_COUNT];
+	uint32_t m_WorkerReportCount;
+
+	WorldReport m_WorldReports[MAX_WORLD_REPORT_COUNT];
+	uint32_t m_WorldReportCount;
+
+	// Sub sessions open that didn't fit in their session
+	uint32_t m_UntrackedDepth;
+
+	// Set on the thread that begins sessions, sub sessions from anywhere else are ignored
+	inline static thread_local bool s_IsSessionThread = false;
 };
 
 #endif // !PROFILER_H
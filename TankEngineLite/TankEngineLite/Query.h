@@ -0,0 +1,147 @@
+//////////////////////////////////////////////////////////////////////////
+// query.h: Cached entity queries of a world, a dense list of the entities
+//		holding a set of component types kept up to date as components are
+//		pushed and popped, so iterating one only costs its matches
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <vector>
+#include <tuple>
+
+namespace ECS
+{
+
+class Entity;
+
+//////////////////////////////////////////////////////////////////////////
+// Class: QueryBase
+// Description: Type erased interface the world keeps its queries up to date through.
+//		Entities are keyed on the index part of their id
+class QueryBase
+{
+public:
+	explicit QueryBase(uint64_t componentMask)
+		: m_ComponentMask(componentMask)
+	{
+	}
+
+	virtual ~QueryBase() = default;
+
+	// The entity just got the last of the components, it isn't in the query yet
+	virtual void Add(Entity* pEntity, uint32_t index) = 0;
+
+	// The entity is about to lose one of the components, it's in the query
+	virtual void Remove(uint32_t index) = 0;
+
+	// One of the components of the entity moved, it's in the query
+	virtual void Refresh(Entity* pEntity, uint32_t index) = 0;
+
+	// Forget every entity, before the world gets rebuilt from a snapshot
+	virtual void Clear() = 0;
+
+	[[nodiscard]] virtual uint32_t GetCount() const = 0;
+
+	// Entity index of every row, in row order
+	[[nodiscard]] virtual const std::vector<uint32_t>& GetIndices() const = 0;
+
+	// Does an entity with this component mask belong in the query
+	[[nodiscard]] constexpr auto IsMatch(uint64_t entityMask) const noexcept -> bool { return (entityMask & m_ComponentMask) == m_ComponentMask; }
+	[[nodiscard]] constexpr auto GetComponentMask() const noexcept -> uint64_t { return m_ComponentMask; }
+
+private:
+	const uint64_t m_ComponentMask;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Query<typename... T>
+// Description: Every entity of the world that has all of T, with pointers to those components.
+//		Rows are packed, removing one moves the last row in to its place. Get one with World::GetQuery
+// Usage:
+//		const auto pPlayers = pWorld->GetQuery<PlayerController, TransformComponent2D>();
+//		pPlayers->ForEach([](PlayerController& player, TransformComponent2D& transform) { ... });
+template<typename... T>
+class Query final
+	: public QueryBase
+{
+	static_assert(sizeof...(T) > 0, "A query needs at least one component type");
+
+public:
+	explicit Query(uint64_t componentMask)
+		: QueryBase(componentMask)
+	{
+	}
+
+	RO5(Query);
+
+	// Defined with the entity, they need the components of the entity
+	inline void Add(Entity* pEntity, uint32_t index) override;
+	inline void Refresh(Entity* pEntity, uint32_t index) override;
+
+	void Remove(uint32_t index) override
+	{
+		const uint32_t position = m_Positions[index];
+		const uint32_t last = static_cast<uint32_t>(m_Rows.size()) - 1U;
+
+		// Move the last row in to the hole
+		m_Rows[position] = m_Rows[last];
+		m_Entities[position] = m_Entities[last];
+		m_Positions[m_Indices[last]] = position;
+		m_Indices[position] = m_Indices[last];
+
+		m_Rows.pop_back();
+		m_Entities.pop_back();
+		m_Indices.pop_back();
+		m_Positions[index] = NOT_MATCHED;
+	}
+
+	void Clear() override
+	{
+		m_Rows.clear();
+		m_Entities.clear();
+		m_Indices.clear();
+		m_Positions.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForEach
+	// FullName:  ECS::Query<T...>::ForEach<typename F>
+	// Access:    public
+	// Returns:   void
+	// Description: f(T&...) for every matching entity, last row first. The entity being visited can
+	//		lose its components or be destroyed, entities matching by then aren't visited until the next
+	//		ForEach. Anything else structural goes through the deferred calls of the world
+	// Parameter: F&& f
+	template<typename F>
+	void ForEach(F&& f)
+	{
+		for (size_t row = m_Rows.size(); row > 0U; --row)
+		{
+			// Rows behind the current one can be removed by f, don't trust the count
+			if (row > m_Rows.size())
+				continue;
+
+			std::apply([&f](T*... pComponents) { f(*pComponents...); }, m_Rows[row - 1U]);
+		}
+	}
+
+	[[nodiscard]] inline auto GetCount() const -> uint32_t override { return static_cast<uint32_t>(m_Rows.size()); }
+	[[nodiscard]] inline auto GetIndices() const -> const std::vector<uint32_t>& override { return m_Indices; }
+	[[nodiscard]] inline auto GetEntities() const noexcept -> const std::vector<Entity*>& { return m_Entities; }
+	[[nodiscard]] inline auto GetRow(uint32_t position) const -> const std::tuple<T*...>& { return m_Rows[position]; }
+
+private:
+	static constexpr uint32_t NOT_MATCHED = ~0U;
+
+	std::vector<std::tuple<T*...>> m_Rows;
+	std::vector<Entity*> m_Entities;
+	std::vector<uint32_t> m_Indices; // Entity index of every row
+
+	// Row of every entity index, NOT_MATCHED if it's not in the query
+	std::vector<uint32_t> m_Positions;
+};
+
+};
+
+#endif // !QUERY_H
@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////
+// random.h: Small deterministic random number generator (PCG32), the same seed
+//		gives the same sequence on every platform, compiler and run
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Random
+// Description: Plain data, copy it to save its position in the sequence and copy it
+//		back to replay from there. Not thread safe, every thread draws from its own
+class Random
+{
+public:
+	constexpr Random(uint64_t seed = DEFAULT_SEED)
+		: m_State(0U)
+	{
+		Seed(seed);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Seed
+	// FullName:  Random::Seed
+	// Access:    public
+	// Returns:   void
+	// Description: Restart the sequence
+	// Parameter: uint64_t seed
+	constexpr void Seed(uint64_t seed)
+	{
+		m_State = 0U;
+		Next();
+		m_State += seed;
+		Next();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Next
+	// FullName:  Random::Next
+	// Access:    public
+	// Returns:   uint32_t
+	// Description: Next 32 random bits
+	constexpr uint32_t Next()
+	{
+		const uint64_t state = m_State;
+		m_State = state * MULTIPLIER + INCREMENT;
+
+		const uint32_t xorShifted = static_cast<uint32_t>(((state >> 18U) ^ state) >> 27U);
+		const uint32_t rotation = static_cast<uint32_t>(state >> 59U);
+
+		return (xorShifted >> rotation) | (xorShifted << ((~rotation + 1U) & 31U));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Interval
+	// FullName:  Random::Interval
+	// Access:    public
+	// Returns:   int
+	// Description: Random integer in [min, max]
+	// Parameter: int min
+	// Parameter: int max
+	constexpr int Interval(int min, int max)
+	{
+		const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1U;
+		return static_cast<int>(min + static_cast<int64_t>((Next() * range) >> 32U));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    NextFloat
+	// FullName:  Random::NextFloat
+	// Access:    public
+	// Returns:   float
+	// Description: Random float in [0, 1)
+	constexpr float NextFloat()
+	{
+		return static_cast<float>(Next() >> 8U) * (1.f / 16777216.f);
+	}
+
+	[[nodiscard]] constexpr auto GetState() const noexcept -> uint64_t { return m_State; }
+	constexpr void SetState(uint64_t state) noexcept { m_State = state; }
+
+private:
+	static constexpr uint64_t DEFAULT_SEED = 0x853C49E6748FEA9BULL;
+	static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+	static constexpr uint64_t INCREMENT = 1442695040888963407ULL;
+
+	uint64_t m_State;
+};
+
+#endif // !RANDOM_H
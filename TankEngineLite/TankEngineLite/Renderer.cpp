@@ -57,30 +57,22 @@ bool Renderer::Init(SDL_Window* pWin, int xw, int yh, bool vSync)
 	return true;
 }
 
-void Renderer::ModelRender(ECS::System* pModelRenderSystem)
+void Renderer::ModelRender(ECS::World* pWorld)
 {
-	// If the world system is valid
-	if (pModelRenderSystem)
-	{
-		// Populate sprite batching using the sprite batch render components
-		pModelRenderSystem->ForAll([](ECS::EntityComponent* pC)
-			{
-				static_cast<ModelRenderComponent*>(pC)->Render();
-			});
-	}
+	// Render all the model render components, does nothing if the world has no such system
+	pWorld->ForEach<ModelRenderComponent>([](ModelRenderComponent& render)
+		{
+			render.Render();
+		});
 }
 
-void Renderer::SpriteBatchRender(ECS::System* pWorldRenderSystem) const
+void Renderer::SpriteBatchRender(ECS::World* pWorld) const
 {
-	// If the world system is valid
-	if (pWorldRenderSystem)
-	{
-		// Populate sprite batching using the sprite batch render components
-		pWorldRenderSystem->ForAll([](ECS::EntityComponent* pC)
-			{
-				static_cast<SpriteRenderComponent*>(pC)->Render();
-			});
-	}
+	// Populate sprite batching using the sprite batch render components
+	pWorld->ForEach<SpriteRenderComponent>([](SpriteRenderComponent& render)
+		{
+			render.Render();
+		});
 }
 
 // Engine related rendering and ImGui
@@ -17,8 +17,8 @@ class Renderer
 {
 public:
 	bool Init(SDL_Window* window, int xw, int yh, bool vSync = false);
-	void ModelRender(ECS::System* pModelRenderSystem);
-	void SpriteBatchRender(ECS::System* pWorldRenderSystem) const;
+	void ModelRender(ECS::World* pWorld);
+	void SpriteBatchRender(ECS::World* pWorld) const;
 	void RootRenderBegin() const;
 	void RootRenderEnd() const;
 	void Destroy();
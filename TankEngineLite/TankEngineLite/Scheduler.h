@@ -0,0 +1,263 @@
+//////////////////////////////////////////////////////////////////////////
+// scheduler.h: Read/write sets of world systems and the dependency graph
+//		used to run non-conflicting systems in parallel
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <type_traits>
+#include <typeindex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace ECS
+{
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: ComponentSet<typename... T>
+// Description: List of component types, used to declare what a system reads and writes
+template<typename... T>
+struct ComponentSet
+{
+	static std::vector<std::type_index> ToTypes() { return { std::type_index(typeid(T))... }; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: SystemAccess
+// Description: What a system touches while it updates.
+//		An exclusive system conflicts with every other system, this is the default
+//		for components that don't declare anything since they can reach anything through the world
+struct SystemAccess
+{
+	std::vector<std::type_index> reads;
+	std::vector<std::type_index> writes;
+	bool exclusive = true;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ConflictsWith
+	// FullName:  ECS::SystemAccess::ConflictsWith
+	// Access:    public
+	// Returns:   bool
+	// Qualifier: const
+	// Description: Two systems conflict when either one writes something the other one reads or writes
+	// Parameter: const SystemAccess & other
+	[[nodiscard]] bool ConflictsWith(const SystemAccess& other) const
+	{
+		if (exclusive || other.exclusive)
+			return true;
+
+		const auto Intersects = [](const std::vector<std::type_index>& a, const std::vector<std::type_index>& b)
+		{
+			return std::any_of(a.begin(), a.end(), [&b](const std::type_index& t) { return std::find(b.begin(), b.end(), t) != b.end(); });
+		};
+
+		return Intersects(writes, other.writes) || Intersects(writes, other.reads) || Intersects(reads, other.writes);
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: HasAccessDeclaration<typename T>
+// Description: True when the component declares `using ReadSet = ComponentSet<...>` and
+//		`using WriteSet = ComponentSet<...>`.
+//		Components that declare their access must only do structural changes (creating or destroying
+//		entities) through World::AsyncCreateEntity and World::AsyncDestroyEntity, other systems might be running
+template<typename T, typename = void>
+struct HasAccessDeclaration : std::false_type {};
+
+template<typename T>
+struct HasAccessDeclaration<T, std::void_t<typename T::ReadSet, typename T::WriteSet>> : std::true_type {};
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    MakeSystemAccess
+// FullName:  ECS::MakeSystemAccess<typename T>
+// Access:    public
+// Returns:   SystemAccess
+// Description: Access of the world system updating T, a system always writes its own component
+template<typename T>
+SystemAccess MakeSystemAccess()
+{
+	SystemAccess access{};
+
+	if constexpr (HasAccessDeclaration<T>::value)
+	{
+		access.reads = T::ReadSet::ToTypes();
+		access.writes = T::WriteSet::ToTypes();
+		access.writes.push_back(std::type_index(typeid(T)));
+		access.exclusive = false;
+	}
+
+	return access;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: IsParallelUpdate<typename T>
+// Description: True when the component declares `static constexpr bool ParallelUpdate = true`,
+//		meaning its Update never writes to other entities and the pool can be split over threads
+template<typename T, typename = void>
+struct IsParallelUpdate : std::false_type {};
+
+template<typename T>
+struct IsParallelUpdate<T, std::void_t<decltype(T::ParallelUpdate)>> : std::bool_constant<T::ParallelUpdate> {};
+
+//////////////////////////////////////////////////////////////////////////
+// Enum: DynamicMode
+// Description: How a DYNAMIC system got executed this frame
+enum class DynamicMode { INLINE, OFFLOAD, SPLIT };
+
+//////////////////////////////////////////////////////////////////////////
+// Class: DynamicPolicy
+// Description: Cost model behind ExecutionStyle::DYNAMIC. Keeps a moving average of the update
+//		cost per active component and picks, every frame, to run the system inline on the main thread, 
+//		on a worker, or split over all workers. Thresholds have some slack so it doesn't flip every frame
+class DynamicPolicy
+{
+public:
+	// Below this the overhead of handing the work to a worker is not worth it
+	static constexpr float INLINE_BUDGET = 0.00005f;
+
+	// Above this the system gets split, if it allows it
+	static constexpr float SPLIT_BUDGET = 0.0005f;
+
+	// Less items than this per part and splitting costs more than it gains
+	static constexpr uint32_t MIN_ITEMS_PER_PART = 256U;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Decide
+	// FullName:  ECS::DynamicPolicy::Decide
+	// Access:    public
+	// Returns:   DynamicMode
+	// Description: Pick the execution mode for this frame
+	// Parameter: uint32_t activeCount
+	// Parameter: bool canSplit
+	// Parameter: uint32_t threadCount, workers plus the main thread
+	DynamicMode Decide(uint32_t activeCount, bool canSplit, uint32_t threadCount)
+	{
+		const float predicted = m_CostPerItem * static_cast<float>(activeCount);
+		const uint32_t maxParts = std::min(threadCount, activeCount / MIN_ITEMS_PER_PART);
+
+		// Hysteresis, harder to leave the current mode than to stay in it
+		const float up = (m_Mode == DynamicMode::INLINE) ? 1.25f : 0.75f;
+		const float split = (m_Mode == DynamicMode::SPLIT) ? 0.75f : 1.25f;
+
+		if (canSplit && maxParts > 1U && predicted > SPLIT_BUDGET * split)
+		{
+			m_Mode = DynamicMode::SPLIT;
+			m_PartCount = maxParts;
+		}
+		else if (predicted > INLINE_BUDGET * up)
+		{
+			m_Mode = DynamicMode::OFFLOAD;
+			m_PartCount = 1U;
+		}
+		else
+		{
+			m_Mode = DynamicMode::INLINE;
+			m_PartCount = 1U;
+		}
+
+		m_ActiveCount = activeCount;
+		return m_Mode;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Measure
+	// FullName:  ECS::DynamicPolicy::Measure<typename F>
+	// Access:    public
+	// Returns:   void
+	// Description: Run f and add its time to this frame's cost, safe to call from several threads
+	// Parameter: F&& f
+	template<typename F>
+	void Measure(F&& f)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		f();
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		m_FrameCostNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    EndFrame
+	// FullName:  ECS::DynamicPolicy::EndFrame
+	// Access:    public
+	// Returns:   void
+	// Description: Fold the measured frame cost in to the average, call once all parts are done
+	void EndFrame()
+	{
+		const float frameCost = static_cast<float>(m_FrameCostNs.exchange(0, std::memory_order_relaxed)) * 1e-9f;
+
+		if (m_ActiveCount == 0U)
+			return;
+
+		const float costPerItem = frameCost / static_cast<float>(m_ActiveCount);
+		m_CostPerItem = (m_CostPerItem == 0.f) ? costPerItem : m_CostPerItem + (costPerItem - m_CostPerItem) * 0.1f;
+	}
+
+	[[nodiscard]] inline auto GetMode() const noexcept -> DynamicMode { return m_Mode; }
+	[[nodiscard]] inline auto GetPartCount() const noexcept -> uint32_t { return m_PartCount; }
+	[[nodiscard]] inline auto GetCostPerItem() const noexcept -> float { return m_CostPerItem; }
+
+private:
+	std::atomic<int64_t> m_FrameCostNs{ 0 };
+	float m_CostPerItem = 0.f;
+	uint32_t m_ActiveCount = 0U;
+	uint32_t m_PartCount = 1U;
+	DynamicMode m_Mode = DynamicMode::INLINE;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Method:    BuildSchedule
+// FullName:  ECS::BuildSchedule
+// Access:    public
+// Returns:   std::vector<std::vector<uint32_t>>
+// Description: Orders the given systems in waves, every system in a wave can run in parallel
+//		with the others of that wave. Between conflicting systems the one with the lowest
+//		system id always runs first, so the result is deterministic.
+//		Returns indices in to the given vectors
+// Parameter: const std::vector<uint32_t>& systemIds
+// Parameter: const std::vector<const SystemAccess*>& accesses
+inline std::vector<std::vector<uint32_t>> BuildSchedule(const std::vector<uint32_t>& systemIds, const std::vector<const SystemAccess*>& accesses)
+{
+	const auto count = static_cast<uint32_t>(systemIds.size());
+
+	// Topological order of the graph is the system id order, every edge goes from lower to higher id
+	std::vector<uint32_t> order(count);
+	for (uint32_t i = 0; i < count; ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&systemIds](uint32_t a, uint32_t b) { return systemIds[a] < systemIds[b]; });
+
+	// Wave of a system is one past the latest wave of everything it conflicts with before it
+	std::vector<uint32_t> waveOf(count, 0U);
+	std::vector<std::vector<uint32_t>> waves{};
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t current = order[i];
+		uint32_t wave = 0U;
+
+		for (uint32_t j = 0; j < i; ++j)
+		{
+			const uint32_t previous = order[j];
+
+			if (accesses[current]->ConflictsWith(*accesses[previous]))
+				wave = std::max(wave, waveOf[previous] + 1U);
+		}
+
+		waveOf[current] = wave;
+
+		if (wave >= waves.size())
+			waves.resize(wave + 1U);
+
+		waves[wave].push_back(current);
+	}
+
+	return waves;
+}
+
+};
+
+#endif // !SCHEDULER_H
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <chrono>
+
+Simulation::Simulation(ECS::World* pWorld, uint32_t tickRate, uint32_t historyLength)
+	: m_pWorld(pWorld)
+	, m_FixedDt(1.f / static_cast<float>(tickRate))
+	, m_Accumulator(0.f)
+	, m_Tick(0U)
+	, m_HistoryCount(0U)
+	, m_History(std::max(historyLength, 1U))
+	, m_Latest()
+	, m_Scratch()
+	, m_HasLatest(false)
+	, m_IsResimulating(false)
+	, m_SaveHook()
+	, m_LoadHook()
+	, m_LastRecordTime(0.f)
+	, m_LastResimTime(0.f)
+	, m_LastResimCount(0U)
+{
+	if (tickRate == 0U)
+		throw std::exception("Simulation tick rate can't be 0");
+}
+
+uint32_t Simulation::Advance(float dt)
+{
+	m_Accumulator += std::min(dt, MAX_FRAME_TIME);
+
+	uint32_t ticks = 0U;
+	while (m_Accumulator >= m_FixedDt)
+	{
+		Step(InputManager::GetInstance()->GetFrame());
+		m_Accumulator -= m_FixedDt;
+		++ticks;
+	}
+
+	return ticks;
+}
+
+uint32_t Simulation::Rollback(uint32_t ticks)
+{
+	ticks = std::min(ticks, m_HistoryCount);
+
+	if (ticks == 0U)
+		return 0U;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	const uint64_t historySize = m_History.size();
+	const uint64_t target = m_Tick - ticks;
+	const uint64_t end = m_Tick;
+
+	// Walk the latest state back to the start of the target tick
+	m_Scratch = m_Latest;
+
+	for (uint64_t tick = end - 1U; tick > target; --tick)
+		m_History[(tick - 1U) % historySize].delta.Apply(m_Scratch);
+
+	m_pWorld->RestoreSnapshot(m_Scratch);
+
+	if (m_LoadHook)
+	{
+		ECS::SnapshotReader reader(m_History[target % historySize].gameState);
+		m_LoadHook(reader);
+	}
+
+	// The delta in to the tick before target is still right, don't let the first step overwrite it
+	m_Tick = target;
+	m_HistoryCount -= ticks;
+	m_HasLatest = false;
+
+	const auto pInput = InputManager::GetInstance();
+	const InputFrame live = pInput->GetFrame();
+	m_IsResimulating = true;
+
+	while (m_Tick < end)
+	{
+		const InputFrame input = m_History[m_Tick % historySize].input;
+		pInput->SetFrame(input);
+		Step(input);
+	}
+
+	m_IsResimulating = false;
+	pInput->SetFrame(live);
+
+	m_LastResimCount = ticks;
+	m_LastResimTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count() / static_cast<float>(ticks);
+
+	return ticks;
+}
+
+InputFrame* Simulation::GetRecordedInput(uint64_t tick) noexcept
+{
+	if (tick >= m_Tick || m_Tick - tick > m_HistoryCount)
+		return nullptr;
+
+	return &m_History[tick % m_History.size()].input;
+}
+
+void Simulation::ClearHistory() noexcept
+{
+	m_HistoryCount = 0U;
+	m_HasLatest = false;
+}
+
+void Simulation::SetStateHooks(const SimulationSaveHook& save, const SimulationLoadHook& load)
+{
+	m_SaveHook = save;
+	m_LoadHook = load;
+}
+
+void Simulation::ImGuiDebug()
+{
+	size_t historyBytes = m_Latest.GetByteSize();
+
+	for (const auto& record : m_History)
+		historyBytes += record.delta.GetByteSize() + record.gameState.GetByteSize();
+
+	ImGui::Begin("Simulation");
+	ImGui::Text("Tick: %llu at %.0f Hz", static_cast<unsigned long long>(m_Tick), 1.f / m_FixedDt);
+	ImGui::Text("History: %u / %u ticks, %.1f KB", m_HistoryCount, static_cast<uint32_t>(m_History.size()), static_cast<float>(historyBytes) / 1024.f);
+	ImGui::Text("Recording: %.3f ms per tick", m_LastRecordTime * 1000.f);
+
+	if (m_LastResimCount > 0U)
+		ImGui::Text("Last rollback: %u ticks, %.3f ms per tick", m_LastResimCount, m_LastResimTime * 1000.f);
+
+	ImGui::End();
+}
+
+void Simulation::Step(const InputFrame& input)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	const uint64_t historySize = m_History.size();
+
+	// Record the start of this tick, the previous one only keeps what it takes to get back to it
+	m_pWorld->CaptureSnapshot(m_Scratch);
+
+	if (m_HasLatest)
+		m_History[(m_Tick - 1U) % historySize].delta.Capture(m_Latest, m_Scratch);
+
+	std::swap(m_Latest, m_Scratch);
+	m_HasLatest = true;
+
+	auto& record = m_History[m_Tick % historySize];
+	record.gameState.Clear();
+
+	if (m_SaveHook)
+		m_SaveHook(record.gameState);
+
+	record.input = input;
+	m_LastRecordTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+
+	m_pWorld->Update(m_FixedDt);
+
+	++m_Tick;
+	m_HistoryCount = std::min(m_HistoryCount + 1U, static_cast<uint32_t>(historySize));
+}
@@ -0,0 +1,137 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "ecs.h"
+#include "InputManager.h"
+
+#include <functional>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Hooks for game state that lives outside of the world (counters, level pointers),
+// saved along with every tick and loaded back on rollback
+using SimulationSaveHook = std::function<void(ECS::WorldSnapshot&)>;
+using SimulationLoadHook = std::function<void(ECS::SnapshotReader&)>;
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Simulation
+// Description: Steps a world at a fixed rate no matter the frame time, and keeps the last
+//		historyLength ticks around as snapshot deltas plus the input of every tick so the world can be
+//		rolled back and simulated forward again. The result is the same as long as the world is deterministic,
+//		see the README for what that takes
+class Simulation final
+{
+public:
+	Simulation(ECS::World* pWorld, uint32_t tickRate = 60U, uint32_t historyLength = 32U);
+
+	RO5(Simulation);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Advance
+	// FullName:  Simulation::Advance
+	// Access:    public
+	// Returns:   uint32_t
+	// Description: Run as many fixed ticks as fit in the time passed, the rest carries over to the next frame.
+	//		Every tick records the world and the current input before it runs
+	// Parameter: float dt
+	uint32_t Advance(float dt);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Rollback
+	// FullName:  Simulation::Rollback
+	// Access:    public
+	// Returns:   uint32_t
+	// Description: Put the world back ticks ticks and simulate them again with the recorded input,
+	//		which may have been corrected through GetRecordedInput in the meantime.
+	//		Clamped to the recorded history, returns the number of ticks simulated again
+	// Parameter: uint32_t ticks
+	uint32_t Rollback(uint32_t ticks);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetRecordedInput
+	// FullName:  Simulation::GetRecordedInput
+	// Access:    public
+	// Returns:   InputFrame*
+	// Description: The input tick ran with, nullptr when it's not in the history (anymore)
+	// Parameter: uint64_t tick
+	[[nodiscard]] InputFrame* GetRecordedInput(uint64_t tick) noexcept;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ClearHistory
+	// FullName:  Simulation::ClearHistory
+	// Access:    public
+	// Returns:   void
+	// Description: Forget every recorded tick, call after changing the world in ways a rollback
+	//		shouldn't undo, like restoring a snapshot
+	void ClearHistory() noexcept;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetStateHooks
+	// FullName:  Simulation::SetStateHooks
+	// Access:    public
+	// Returns:   void
+	// Description: Save and load game state that isn't in the world along with every tick
+	// Parameter: const SimulationSaveHook & save
+	// Parameter: const SimulationLoadHook & load
+	void SetStateHooks(const SimulationSaveHook& save, const SimulationLoadHook& load);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ImGuiDebug
+	// FullName:  Simulation::ImGuiDebug
+	// Access:    public
+	// Returns:   void
+	// Description: Tick, history size and the cost of the last rollback
+	void ImGuiDebug();
+
+	[[nodiscard]] constexpr auto GetTick() const noexcept -> uint64_t { return m_Tick; }
+	[[nodiscard]] constexpr auto GetFixedDeltaTime() const noexcept -> float { return m_FixedDt; }
+	[[nodiscard]] constexpr auto GetHistoryCount() const noexcept -> uint32_t { return m_HistoryCount; }
+
+	// Seconds per tick simulated again by the last Rollback, restoring included
+	[[nodiscard]] constexpr auto GetLastResimulationTime() const noexcept -> float { return m_LastResimTime; }
+
+	// True while Rollback simulates ticks again. Sounds, rumble and other effects outside of the world
+	//  already happened the first time those ticks ran, the game skips them
+	[[nodiscard]] constexpr auto IsResimulating() const noexcept -> bool { return m_IsResimulating; }
+
+private:
+	//////////////////////////////////////////////////////////////////////////
+	// Struct: TickRecord
+	// Description: What it takes to go back to the start of a tick, the delta to the tick
+	//		before it is filled in once the next tick starts
+	struct TickRecord
+	{
+		ECS::SnapshotDelta delta;
+		ECS::WorldSnapshot gameState;
+		InputFrame input;
+	};
+
+	void Step(const InputFrame& input);
+
+	// Frames longer than this are cut short instead of spiraling in to more and more ticks
+	static constexpr float MAX_FRAME_TIME = 0.25f;
+
+	ECS::World* m_pWorld;
+	float m_FixedDt;
+	float m_Accumulator;
+
+	uint64_t m_Tick;
+	uint32_t m_HistoryCount;
+	std::vector<TickRecord> m_History; // Ring, tick % size
+
+	// World at the start of the last tick, and a scratch snapshot to capture and rewind in to
+	ECS::WorldSnapshot m_Latest;
+	ECS::WorldSnapshot m_Scratch;
+	bool m_HasLatest;
+	bool m_IsResimulating;
+
+	SimulationSaveHook m_SaveHook;
+	SimulationLoadHook m_LoadHook;
+
+	// Stats
+	float m_LastRecordTime;
+	float m_LastResimTime;
+	uint32_t m_LastResimCount;
+};
+
+#endif // !SIMULATION_H
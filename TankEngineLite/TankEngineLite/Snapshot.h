@@ -0,0 +1,357 @@
+//////////////////////////////////////////////////////////////////////////
+// snapshot.h: Binary snapshot of a world, the storage of every system and
+//		archetype plus the entity table, restored in place in to the same world.
+//		Deltas between two snapshots for keeping a history of them
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ECS
+{
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: IsSnapshotCopied<typename T>
+// Description: True when the component declares `static constexpr bool SnapshotByCopy = true`.
+//		Components are stored as the raw bytes of their pool by default, which is only right for
+//		plain data and pointers in to the world. Components that own memory (std::function, containers)
+//		opt in to being copy constructed in to the snapshot and back out of it instead
+template<typename T, typename = void>
+struct IsSnapshotCopied : std::false_type {};
+
+template<typename T>
+struct IsSnapshotCopied<T, std::void_t<decltype(T::SnapshotByCopy)>> : std::bool_constant<T::SnapshotByCopy> {};
+
+class SnapshotReader;
+class SnapshotDelta;
+
+//////////////////////////////////////////////////////////////////////////
+// Class: WorldSnapshot
+// Description: What World::CaptureSnapshot writes, a flat byte blob plus the copies of the
+//		components that can't live in it. Pools, chunks and entity pages never move, so the
+//		pointers in the blob stay valid as long as it goes back in to the world it came from.
+//		Capturing in to the same snapshot again reuses its memory
+class WorldSnapshot
+{
+	friend class SnapshotReader;
+	friend class SnapshotDelta;
+
+public:
+	WorldSnapshot() = default;
+
+	inline void Clear()
+	{
+		m_Blob.clear();
+		m_Copies.clear();
+	}
+
+	inline void Write(const void* pData, size_t size)
+	{
+		if (size == 0U)
+			return;
+
+		const auto pBytes = static_cast<const uint8_t*>(pData);
+		m_Blob.insert(m_Blob.end(), pBytes, pBytes + size);
+	}
+
+	template<typename T>
+	inline void WriteValue(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values go in to the blob directly");
+		Write(&value, sizeof(T));
+	}
+
+	template<typename T>
+	inline void WriteVector(const std::vector<T>& values)
+	{
+		WriteValue(static_cast<uint32_t>(values.size()));
+		Write(values.data(), values.size() * sizeof(T));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    WritePaddedVector
+	// FullName:  ECS::WorldSnapshot::WritePaddedVector<typename T>
+	// Access:    public
+	// Returns:   void
+	// Description: Like WriteVector but always takes up capacity elements, so whatever comes after it
+	//		stays at the same offset while the list grows and shrinks. Keeps SnapshotDelta small
+	// Parameter: const std::vector<T> & values
+	// Parameter: size_t capacity
+	template<typename T>
+	inline void WritePaddedVector(const std::vector<T>& values, size_t capacity)
+	{
+		WriteVector(values);
+
+		if (capacity > values.size())
+			m_Blob.resize(m_Blob.size() + (capacity - values.size()) * sizeof(T), 0U);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    WriteColumn
+	// FullName:  ECS::WorldSnapshot::WriteColumn<typename T, typename F>
+	// Access:    public
+	// Returns:   void
+	// Description: Store count components laid out contiguously, the whole block in one go.
+	//		Components that are SnapshotByCopy get a copy of the slots isAlive(i) says are in use
+	// Parameter: const T * pColumn
+	// Parameter: uint32_t count
+	// Parameter: F&& isAlive
+	template<typename T, typename F>
+	void WriteColumn(const T* pColumn, uint32_t count, F&& isAlive)
+	{
+		if constexpr (IsSnapshotCopied<T>::value)
+		{
+			auto pCopies = std::make_shared<std::vector<T>>();
+
+			for (uint32_t i = 0U; i < count; ++i)
+			{
+				if (isAlive(i))
+					pCopies->push_back(pColumn[i]);
+			}
+
+			m_Copies.push_back(std::move(pCopies));
+		}
+		else
+			Write(static_cast<const void*>(pColumn), count * sizeof(T));
+	}
+
+	[[nodiscard]] inline auto GetByteSize() const noexcept -> size_t { return m_Blob.size(); }
+	[[nodiscard]] inline auto GetCopyCount() const noexcept -> size_t { return m_Copies.size(); }
+	[[nodiscard]] inline auto IsEmpty() const noexcept -> bool { return m_Blob.empty(); }
+
+private:
+	std::vector<uint8_t> m_Blob;
+
+	// One list per column of SnapshotByCopy components, in the order they got written
+	std::vector<std::shared_ptr<void>> m_Copies;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: SnapshotReader
+// Description: Reads a snapshot back in the order it got written
+class SnapshotReader
+{
+public:
+	SnapshotReader(const WorldSnapshot& snapshot)
+		: m_Snapshot(snapshot)
+		, m_Offset(0U)
+		, m_CopyIndex(0U)
+	{
+	}
+
+	RO5(SnapshotReader);
+
+	// Pointer to the next size bytes of the blob
+	inline const uint8_t* Read(size_t size)
+	{
+		if (m_Offset + size > m_Snapshot.m_Blob.size())
+			throw std::exception("Snapshot is truncated");
+
+		const uint8_t* pData = m_Snapshot.m_Blob.data() + m_Offset;
+		m_Offset += size;
+		return pData;
+	}
+
+	inline void Read(void* pOut, size_t size)
+	{
+		if (size == 0U)
+			return;
+
+		std::memcpy(pOut, Read(size), size);
+	}
+
+	template<typename T>
+	[[nodiscard]] inline T ReadValue()
+	{
+		T value{};
+		Read(&value, sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	inline void ReadVector(std::vector<T>& values)
+	{
+		values.resize(ReadValue<uint32_t>());
+		Read(values.data(), values.size() * sizeof(T));
+	}
+
+	// Counterpart of WorldSnapshot::WritePaddedVector
+	template<typename T>
+	inline void ReadPaddedVector(std::vector<T>& values, size_t capacity)
+	{
+		ReadVector(values);
+
+		if (values.size() > capacity)
+			throw std::exception("Snapshot is corrupt");
+
+		Read((capacity - values.size()) * sizeof(T));
+	}
+
+	// Step over what WritePaddedVector wrote without reading the values
+	template<typename T>
+	inline void SkipPaddedVector(size_t capacity)
+	{
+		if (ReadValue<uint32_t>() > capacity)
+			throw std::exception("Snapshot is corrupt");
+
+		Read(capacity * sizeof(T));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ReadColumn
+	// FullName:  ECS::SnapshotReader::ReadColumn<typename T, typename F>
+	// Access:    public
+	// Returns:   void
+	// Description: Counterpart of WorldSnapshot::WriteColumn. The column must hold no live objects,
+	//		isAlive(i) already answers for the restored state
+	// Parameter: T * pColumn
+	// Parameter: uint32_t count
+	// Parameter: F&& isAlive
+	template<typename T, typename F>
+	void ReadColumn(T* pColumn, uint32_t count, F&& isAlive)
+	{
+		if constexpr (IsSnapshotCopied<T>::value)
+		{
+			if (m_CopyIndex >= m_Snapshot.m_Copies.size())
+				throw std::exception("Snapshot is truncated");
+
+			const auto& copies = *static_cast<const std::vector<T>*>(m_Snapshot.m_Copies[m_CopyIndex++].get());
+			size_t next = 0U;
+
+			for (uint32_t i = 0U; i < count; ++i)
+			{
+				if (isAlive(i))
+					new (&pColumn[i]) T(copies[next++]);
+			}
+		}
+		else
+			Read(static_cast<void*>(pColumn), count * sizeof(T));
+	}
+
+	// Step over a column without restoring it, for checking a snapshot before restoring it
+	template<typename T>
+	void SkipColumn(uint32_t count)
+	{
+		if constexpr (IsSnapshotCopied<T>::value)
+		{
+			if (m_CopyIndex >= m_Snapshot.m_Copies.size())
+				throw std::exception("Snapshot is truncated");
+
+			++m_CopyIndex;
+		}
+		else
+			Read(count * sizeof(T));
+	}
+
+	[[nodiscard]] inline auto GetOffset() const noexcept -> size_t { return m_Offset; }
+	[[nodiscard]] inline auto IsDone() const noexcept -> bool { return m_Offset == m_Snapshot.m_Blob.size(); }
+
+private:
+	const WorldSnapshot& m_Snapshot;
+	size_t m_Offset;
+	size_t m_CopyIndex;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: SnapshotDelta
+// Description: The blocks of one snapshot that differ from a later one of the same world,
+//		enough to turn the later one back in to it. Consecutive snapshots line up byte for byte
+//		as long as no entity slots or chunks got added, see World::CaptureSnapshot for the layout.
+//		The component copies of SnapshotByCopy types are shared with the snapshot, not diffed
+class SnapshotDelta
+{
+public:
+	// Granularity of the comparison, neighbouring blocks that differ are merged
+	static constexpr size_t BLOCK_SIZE = 64U;
+
+	SnapshotDelta() = default;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Capture
+	// FullName:  ECS::SnapshotDelta::Capture
+	// Access:    public
+	// Returns:   void
+	// Description: Store what Apply needs to turn to back in to from
+	// Parameter: const WorldSnapshot & from
+	// Parameter: const WorldSnapshot & to
+	void Capture(const WorldSnapshot& from, const WorldSnapshot& to)
+	{
+		m_Blocks.clear();
+		m_Bytes.clear();
+		m_BlobSize = from.m_Blob.size();
+		m_Copies = from.m_Copies;
+
+		const uint8_t* pFrom = from.m_Blob.data();
+		const uint8_t* pTo = to.m_Blob.data();
+		const size_t common = std::min(from.m_Blob.size(), to.m_Blob.size());
+
+		for (size_t offset = 0U; offset < common; offset += BLOCK_SIZE)
+		{
+			const size_t size = std::min(BLOCK_SIZE, common - offset);
+
+			if (std::memcmp(pFrom + offset, pTo + offset, size) != 0)
+				AddBlock(pFrom, offset, size);
+		}
+
+		// Whatever from has past the end of to
+		if (from.m_Blob.size() > common)
+			AddBlock(pFrom, common, from.m_Blob.size() - common);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Apply
+	// FullName:  ECS::SnapshotDelta::Apply
+	// Access:    public
+	// Returns:   void
+	// Description: Turn the snapshot Capture compared against back in to the one before it
+	// Parameter: WorldSnapshot & snapshot
+	void Apply(WorldSnapshot& snapshot) const
+	{
+		snapshot.m_Blob.resize(m_BlobSize);
+		snapshot.m_Copies = m_Copies;
+
+		const uint8_t* pBytes = m_Bytes.data();
+
+		for (const auto& block : m_Blocks)
+		{
+			std::memcpy(snapshot.m_Blob.data() + block.offset, pBytes, block.size);
+			pBytes += block.size;
+		}
+	}
+
+	[[nodiscard]] inline auto GetByteSize() const noexcept -> size_t { return m_Bytes.size(); }
+	[[nodiscard]] inline auto GetBlockCount() const noexcept -> size_t { return m_Blocks.size(); }
+
+private:
+	struct Block
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	inline void AddBlock(const uint8_t* pFrom, size_t offset, size_t size)
+	{
+		if (!m_Blocks.empty() && m_Blocks.back().offset + m_Blocks.back().size == offset)
+			m_Blocks.back().size += size;
+		else
+			m_Blocks.push_back({ offset, size });
+
+		m_Bytes.insert(m_Bytes.end(), pFrom + offset, pFrom + offset + size);
+	}
+
+	std::vector<Block> m_Blocks;
+	std::vector<uint8_t> m_Bytes;
+	size_t m_BlobSize = 0U;
+	std::vector<std::shared_ptr<void>> m_Copies;
+};
+
+};
+
+#endif // !SNAPSHOT_H
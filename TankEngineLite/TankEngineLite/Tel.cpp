@@ -34,7 +34,8 @@ void TEngineRunner::Initialize()
 	InitializeWindow();
 	SoundManager::GetInstance()->Init();
 
-	// Initialize universe
+	// Spin up the workers and initialize universe
+	ThreadPool::GetInstance();
 	ECS::Universe::GetInstance();
 
 	// Start game
@@ -52,6 +53,7 @@ void TEngineRunner::Cleanup()
 	SDL_Quit();
 	
 	m_pGame->Shutdown();
+	ThreadPool::GetInstance()->Destroy();
 	Profiler::GetInstance()->Destroy();
 	ResourceManager::GetInstance()->Destroy();
 	SoundManager::GetInstance()->Destroy();
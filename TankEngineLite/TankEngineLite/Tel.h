@@ -15,6 +15,7 @@
 #include "Renderer.h"
 
 #include "MemoryTracker.h"
+#include "ThreadPool.h"
 
 #include "SoundManager.h"
 
@@ -134,6 +135,7 @@ public:
 				std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
 				dt = t2 - t1;
 
+				ThreadPool::GetInstance()->ReportToProfiler();
 				pProfiler->EndSession();
 			}
 		}
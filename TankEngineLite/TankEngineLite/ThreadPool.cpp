@@ -0,0 +1,242 @@
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+ThreadPool::ThreadPool()
+	: m_Workers()
+	, m_pTimings()
+	, m_Jobs()
+	, m_Mutex()
+	, m_JobAvailable()
+	, m_Stop(false)
+{
+	s_ThreadIndex = 0U;
+
+	// The main thread takes part while waiting, so leave a core for it
+	const uint32_t cores = std::thread::hardware_concurrency();
+	const uint32_t workerCount = (cores > 1U) ? cores - 1U : 1U;
+
+	m_pTimings = std::make_unique<WorkerTiming[]>(workerCount);
+	m_Workers.reserve(workerCount);
+
+	for (uint32_t i = 0U; i < workerCount; ++i)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	Destroy();
+}
+
+void ThreadPool::Submit(JobGroup& group, std::function<void()> job)
+{
+	group.pending.fetch_add(1U, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Jobs.push_back({ std::move(job), &group });
+	}
+
+	m_JobAvailable.notify_one();
+}
+
+void ThreadPool::Wait(JobGroup& group)
+{
+	while (group.pending.load(std::memory_order_acquire) > 0U)
+	{
+		// Help out, if there's nothing left to pick up the remaining jobs are already running
+		if (!TryRunOne())
+			std::this_thread::yield();
+	}
+
+	if (group.exception)
+	{
+		auto exception = group.exception;
+		group.exception = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+void ThreadPool::SubmitParallelFor(JobGroup& group, uint32_t count, uint32_t jobCount, std::function<void(uint32_t)> func)
+{
+	auto pState = std::make_shared<ParallelForState>();
+	pState->count = count;
+	pState->func = std::move(func);
+
+	for (uint32_t i = 0U; i < jobCount; ++i)
+		Submit(group, [pState]() { pState->Drain(); });
+}
+
+void ThreadPool::ParallelFor(uint32_t count, uint32_t maxThreads, const std::function<void(uint32_t)>& func)
+{
+	// Workers to bring in, the calling thread is one of the threads
+	uint32_t jobCount = GetWorkerCount();
+
+	if (maxThreads != 0U)
+		jobCount = std::min(jobCount, maxThreads - 1U);
+
+	jobCount = std::min(jobCount, (count > 0U) ? count - 1U : 0U);
+
+	if (jobCount == 0U)
+	{
+		for (uint32_t i = 0U; i < count; ++i)
+			func(i);
+
+		return;
+	}
+
+	JobGroup group{};
+	auto pState = std::make_shared<ParallelForState>();
+	pState->count = count;
+	pState->func = func;
+
+	for (uint32_t i = 0U; i < jobCount; ++i)
+		Submit(group, [pState]() { pState->Drain(); });
+
+	// Take part, the group has to be joined before it goes out of scope even when this throws
+	std::exception_ptr exception{};
+
+	try
+	{
+		pState->Drain();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	Wait(group);
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void ThreadPool::ReportToProfiler()
+{
+	const auto pProfiler = Profiler::GetInstance();
+
+	for (uint32_t i = 0U; i < GetWorkerCount(); ++i)
+	{
+		const auto busy = m_pTimings[i].busyNs.exchange(0, std::memory_order_relaxed);
+		const auto idle = m_pTimings[i].idleNs.exchange(0, std::memory_order_relaxed);
+
+		pProfiler->RecordWorker(i, static_cast<float>(busy) * 1e-9f, static_cast<float>(idle) * 1e-9f);
+	}
+}
+
+void ThreadPool::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Stop)
+			return;
+
+		m_Stop = true;
+	}
+
+	m_JobAvailable.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+
+	m_Workers.clear();
+
+	// Nobody is going to run these anymore, let whoever waits on their groups go
+	std::deque<Job> dropped{};
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		dropped.swap(m_Jobs);
+	}
+
+	for (auto& job : dropped)
+		Drop(job);
+}
+
+void ThreadPool::WorkerLoop(uint32_t workerIndex)
+{
+	using clock = std::chrono::high_resolution_clock;
+	auto& timing = m_pTimings[workerIndex];
+	s_ThreadIndex = workerIndex + 1U;
+
+	while (true)
+	{
+		Job job{};
+
+		// Park until there is work
+		const auto idleStart = clock::now();
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobAvailable.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+
+			if (m_Stop)
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+		const auto busyStart = clock::now();
+
+		Run(job);
+
+		const auto busyEnd = clock::now();
+		timing.idleNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(busyStart - idleStart).count(), std::memory_order_relaxed);
+		timing.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(busyEnd - busyStart).count(), std::memory_order_relaxed);
+	}
+}
+
+bool ThreadPool::TryRunOne()
+{
+	Job job{};
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Jobs.empty())
+			return false;
+
+		job = std::move(m_Jobs.front());
+		m_Jobs.pop_front();
+	}
+
+	Run(job);
+	return true;
+}
+
+void ThreadPool::ParallelForState::Drain()
+{
+	for (uint32_t i = next.fetch_add(1U, std::memory_order_relaxed); i < count; i = next.fetch_add(1U, std::memory_order_relaxed))
+		func(i);
+}
+
+void ThreadPool::Run(Job& job)
+{
+	try
+	{
+		job.func();
+	}
+	catch (...)
+	{
+		// Hand it over to whoever waits on the group
+		std::lock_guard<std::mutex> lock(job.pGroup->exceptionMutex);
+
+		if (!job.pGroup->exception)
+			job.pGroup->exception = std::current_exception();
+	}
+
+	job.pGroup->pending.fetch_sub(1U, std::memory_order_release);
+}
+
+void ThreadPool::Drop(Job& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(job.pGroup->exceptionMutex);
+
+		if (!job.pGroup->exception)
+			job.pGroup->exception = std::make_exception_ptr(std::exception("Job dropped, the thread pool was destroyed"));
+	}
+
+	job.pGroup->pending.fetch_sub(1U, std::memory_order_release);
+}
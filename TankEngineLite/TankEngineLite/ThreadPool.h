@@ -0,0 +1,153 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "Singleton.h"
+
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: JobGroup
+// Description: Counts the jobs submitted with it that have not finished yet,
+//		ThreadPool::Wait on a group is the join point and rethrows the first exception a job threw
+struct JobGroup
+{
+	std::atomic<uint32_t> pending{ 0U };
+
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: ThreadPool
+// Description: Engine owned pool of persistent worker threads, one per core minus the main thread.
+//		Workers are parked on a condition variable until jobs get submitted
+// Usage:
+//		JobGroup group{};
+//		THREADPOOL->Submit(group, []() { ... });
+//		THREADPOOL->Wait(group);
+class ThreadPool
+	: public Singleton<ThreadPool>
+{
+public:
+	ThreadPool();
+	~ThreadPool() override;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Submit
+	// FullName:  ThreadPool::Submit
+	// Access:    public
+	// Returns:   void
+	// Description: Queue a job on the workers, the group keeps track of it until it finishes
+	// Parameter: JobGroup & group
+	// Parameter: std::function<void()> job
+	void Submit(JobGroup& group, std::function<void()> job);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Wait
+	// FullName:  ThreadPool::Wait
+	// Access:    public
+	// Returns:   void
+	// Description: Block until all jobs of the group are done,
+	//		the calling thread runs queued jobs in the mean time instead of sleeping
+	// Parameter: JobGroup & group
+	void Wait(JobGroup& group);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SubmitParallelFor
+	// FullName:  ThreadPool::SubmitParallelFor
+	// Access:    public
+	// Returns:   void
+	// Description: Queue jobCount jobs that together call func(i) for every i in [0, count).
+	//		Indices are claimed one at a time from a shared counter, a job that finishes early 
+	//		keeps taking over the indices the slower ones haven't reached yet
+	// Parameter: JobGroup & group
+	// Parameter: uint32_t count
+	// Parameter: uint32_t jobCount
+	// Parameter: std::function<void(uint32_t)> func
+	void SubmitParallelFor(JobGroup& group, uint32_t count, uint32_t jobCount, std::function<void(uint32_t)> func);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ParallelFor
+	// FullName:  ThreadPool::ParallelFor
+	// Access:    public
+	// Returns:   void
+	// Description: Call func(i) for every i in [0, count) on up to maxThreads threads, the calling one included,
+	//		returns once all are done. maxThreads of 0 uses every worker
+	// Parameter: uint32_t count
+	// Parameter: uint32_t maxThreads
+	// Parameter: const std::function<void(uint32_t)> & func
+	void ParallelFor(uint32_t count, uint32_t maxThreads, const std::function<void(uint32_t)>& func);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ReportToProfiler
+	// FullName:  ThreadPool::ReportToProfiler
+	// Access:    public
+	// Returns:   void
+	// Description: Push the busy and idle time of every worker since the last call to the profiler
+	void ReportToProfiler();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Destroy
+	// FullName:  ThreadPool::Destroy
+	// Access:    public
+	// Returns:   void
+	// Description: Stop and join all workers, jobs still queued are dropped.
+	//		Their groups are released with an exception, so Wait on them returns
+	void Destroy();
+
+	[[nodiscard]] inline auto GetWorkerCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Workers.size()); }
+
+	// Index of the calling thread, 0 for the thread that created the pool and 1 + worker index for the workers,
+	//  INVALID_THREAD_INDEX for any other thread
+	static constexpr uint32_t INVALID_THREAD_INDEX = ~0U;
+	[[nodiscard]] static inline auto GetThreadIndex() noexcept -> uint32_t { return s_ThreadIndex; }
+
+private:
+	struct Job
+	{
+		std::function<void()> func;
+		JobGroup* pGroup;
+	};
+
+	struct ParallelForState
+	{
+		std::atomic<uint32_t> next{ 0U };
+		uint32_t count;
+		std::function<void(uint32_t)> func;
+
+		void Drain();
+	};
+
+	struct WorkerTiming
+	{
+		std::atomic<int64_t> busyNs{ 0 };
+		std::atomic<int64_t> idleNs{ 0 };
+	};
+
+	void WorkerLoop(uint32_t workerIndex);
+	bool TryRunOne();
+	static void Run(Job& job);
+	static void Drop(Job& job);
+
+	std::vector<std::thread> m_Workers;
+	std::unique_ptr<WorkerTiming[]> m_pTimings;
+
+	std::deque<Job> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_JobAvailable;
+	bool m_Stop;
+
+	inline static thread_local uint32_t s_ThreadIndex = INVALID_THREAD_INDEX;
+};
+
+#define THREADPOOL ThreadPool::GetInstance()
+
+#endif // !THREAD_POOL_H
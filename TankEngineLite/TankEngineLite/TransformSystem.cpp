@@ -0,0 +1,240 @@
+#include "pch.h"
+#include "TransformSystem.h"
+#include "ThreadPool.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+
+SceneGraph::SceneGraph()
+	: m_Transforms()
+	, m_Parents()
+	, m_Levels(1U, 0U)
+	, m_World()
+	, m_Recomputed()
+	, m_Batch()
+	, m_Scales()
+	, m_Rotations()
+	, m_Positions()
+	, m_HierarchyCount(0U)
+	, m_LastTick(0U)
+	, m_IsStale(true)
+	, m_RecomputeAll(true)
+	, m_LastRecomputedCount(0U)
+	, m_LastPropagateTime(0.f)
+{
+}
+
+bool SceneGraph::IsStale(ECS::World* pWorld, uint32_t transformCount) const
+{
+	if (m_IsStale || transformCount != m_Transforms.size())
+		return true;
+
+	const auto pSystem = pWorld->GetSystemByComponent<HierarchyComponent>();
+
+	if (pSystem == nullptr)
+		return false;
+
+	if (pSystem->GetActiveCount() != m_HierarchyCount)
+		return true;
+
+	// Parents set since the last sort, new components haven't been sorted at all
+	bool isReparented = false;
+	static_cast<ECS::ComponentSystem<HierarchyComponent>*>(pSystem)->ForEach([&isReparented](HierarchyComponent& hierarchy)
+		{
+			isReparented |= (hierarchy.m_ParentId != hierarchy.m_SortedParentId);
+		});
+
+	return isReparented;
+}
+
+void SceneGraph::Rebuild(ECS::World* pWorld, const std::vector<TransformComponent*>& transforms)
+{
+	const uint32_t count = static_cast<uint32_t>(transforms.size());
+	m_HierarchyCount = 0U;
+
+	if (const auto pSystem = pWorld->GetSystemByComponent<HierarchyComponent>(); pSystem)
+	{
+		m_HierarchyCount = pSystem->GetActiveCount();
+		static_cast<ECS::ComponentSystem<HierarchyComponent>*>(pSystem)->ForEach([](HierarchyComponent& hierarchy)
+			{
+				hierarchy.m_SortedParentId = hierarchy.m_ParentId;
+				hierarchy.m_Depth = 0U;
+			});
+	}
+
+	// Parent of every transform, the transform of the entity its hierarchy component points at
+	std::unordered_map<const TransformComponent*, uint32_t> indices{};
+	indices.reserve(count);
+
+	for (uint32_t i = 0U; i < count; ++i)
+		indices[transforms[i]] = i;
+
+	std::vector<uint32_t> parents(count, ROOT);
+	std::vector<HierarchyComponent*> hierarchies(count, nullptr);
+
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		hierarchies[i] = transforms[i]->GetOwner()->GetComponent<HierarchyComponent>();
+
+		if (hierarchies[i] == nullptr)
+			continue;
+
+		const auto pParent = hierarchies[i]->GetParent();
+		const auto pParentTransform = (pParent) ? pParent->GetComponent<TransformComponent>() : nullptr;
+
+		if (const auto it = indices.find(pParentTransform); it != indices.end())
+			parents[i] = it->second;
+	}
+
+	// Depth of every transform, walk up until a known depth and fill in the chain on the way back
+	constexpr uint32_t UNKNOWN_DEPTH = ~0U;
+	std::vector<uint32_t> depths(count, UNKNOWN_DEPTH);
+	std::vector<uint32_t> chain{};
+	uint32_t maxDepth = 0U;
+
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		chain.clear();
+
+		uint32_t node = i;
+		while (node != ROOT && depths[node] == UNKNOWN_DEPTH)
+		{
+			if (chain.size() == count)
+				throw std::exception("Transform hierarchy contains a cycle");
+
+			chain.push_back(node);
+			node = parents[node];
+		}
+
+		uint32_t depth = (node == ROOT) ? 0U : depths[node] + 1U;
+
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			depths[*it] = depth++;
+
+		maxDepth = std::max(maxDepth, depths[i]);
+	}
+
+	// Counting sort on depth, transforms keep their pool order inside a level
+	m_Levels.assign(maxDepth + 2U, 0U);
+
+	for (uint32_t i = 0U; i < count; ++i)
+		++m_Levels[depths[i] + 1U];
+
+	for (size_t level = 1U; level < m_Levels.size(); ++level)
+		m_Levels[level] += m_Levels[level - 1U];
+
+	std::vector<uint32_t> sorted(count, 0U);
+	std::vector<uint32_t> next(m_Levels.begin(), m_Levels.end() - 1U);
+
+	for (uint32_t i = 0U; i < count; ++i)
+		sorted[i] = next[depths[i]]++;
+
+	m_Transforms.resize(count);
+	m_Parents.resize(count);
+
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		m_Transforms[sorted[i]] = transforms[i];
+		m_Parents[sorted[i]] = (parents[i] == ROOT) ? ROOT : sorted[parents[i]];
+
+		if (hierarchies[i])
+			hierarchies[i]->m_Depth = depths[i];
+	}
+
+	m_World.resize(count);
+	m_Recomputed.assign(count, 0U);
+	m_IsStale = false;
+	m_RecomputeAll = true;
+}
+
+void SceneGraph::Propagate(ECS::World* pWorld)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	const uint32_t tick = pWorld->GetChangeTick();
+	uint32_t recomputedCount = 0U;
+
+	for (size_t level = 0U; level + 1U < m_Levels.size(); ++level)
+	{
+		m_Batch.clear();
+		m_Scales.clear();
+		m_Rotations.clear();
+		m_Positions.clear();
+
+		// Gather what changed, changes made after the last propagation in its own tick carry that tick too
+		for (uint32_t node = m_Levels[level]; node < m_Levels[level + 1U]; ++node)
+		{
+			const auto pTransform = m_Transforms[node];
+			const uint32_t parent = m_Parents[node];
+
+			const bool isDirty = m_RecomputeAll || pTransform->IsChangedSince(m_LastTick) || (parent != ROOT && m_Recomputed[parent]);
+			m_Recomputed[node] = static_cast<uint8_t>(isDirty);
+
+			if (!isDirty)
+				continue;
+
+			m_Batch.push_back(node);
+			m_Scales.push_back(XMLoadFloat3(&pTransform->scale));
+			m_Rotations.push_back(XMLoadFloat4(&pTransform->rotationQ));
+			m_Positions.push_back(XMLoadFloat3(&pTransform->position));
+		}
+
+		const uint32_t batchSize = static_cast<uint32_t>(m_Batch.size());
+		recomputedCount += batchSize;
+
+		// The parents are all in earlier levels, the nodes of one level don't depend on each other
+		if (batchSize >= PARALLEL_BATCH_SIZE * 2U)
+		{
+			const uint32_t jobCount = (batchSize + PARALLEL_BATCH_SIZE - 1U) / PARALLEL_BATCH_SIZE;
+
+			ThreadPool::GetInstance()->ParallelFor(jobCount, 0U, [this, batchSize, tick](uint32_t job)
+				{
+					const uint32_t begin = job * PARALLEL_BATCH_SIZE;
+					ComputeBatch(begin, std::min(begin + PARALLEL_BATCH_SIZE, batchSize), tick);
+				});
+		}
+		else
+			ComputeBatch(0U, batchSize, tick);
+	}
+
+	m_LastTick = tick;
+	m_RecomputeAll = false;
+	m_LastRecomputedCount = recomputedCount;
+	m_LastPropagateTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void SceneGraph::ImGuiDebug() const
+{
+	if (ImGui::BeginTabItem("Scene graph"))
+	{
+		ImGui::Separator();
+
+		ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Nodes: ");
+		ImGui::SameLine();
+		ImGui::Text("%u in %u levels", GetNodeCount(), GetLevelCount());
+
+		ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Last propagation: ");
+		ImGui::SameLine();
+		ImGui::Text("%u recomputed, %.3f ms", m_LastRecomputedCount, m_LastPropagateTime * 1000.f);
+
+		ImGui::EndTabItem();
+	}
+}
+
+void SceneGraph::ComputeBatch(uint32_t begin, uint32_t end, uint32_t tick)
+{
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		// Scale then rotate, the translation goes straight in to the last row
+		XMMATRIX local = XMMatrixMultiply(XMMatrixScalingFromVector(m_Scales[i]), XMMatrixRotationQuaternion(m_Rotations[i]));
+		local.r[3] = XMVectorSelect(g_XMIdentityR3.v, m_Positions[i], g_XMSelect1110.v);
+
+		const uint32_t node = m_Batch[i];
+		const uint32_t parent = m_Parents[node];
+		m_World[node] = (parent == ROOT) ? local : XMMatrixMultiply(local, m_World[parent]);
+
+		const auto pTransform = m_Transforms[node];
+		XMStoreFloat4x4(&pTransform->m_WorldMatrix, m_World[node]);
+		pTransform->m_WorldTick = tick;
+	}
+}
@@ -0,0 +1,210 @@
+#ifndef TRANSFORM_SYSTEM_H
+#define TRANSFORM_SYSTEM_H
+
+#include "ecs.h"
+#include "CoreComponents.h"
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Class: SceneGraph
+// Description: Flat copy of the transform hierarchy sorted by depth, every parent comes before its children
+//		and each depth is one contiguous level. Propagating walks the levels top down, the transforms that changed
+//		and everything below them are gathered in to SoA batches of scale, rotation and position and turned
+//		in to world matrices in one tight DirectXMath loop, the rest keep their cached matrix
+class SceneGraph final
+{
+public:
+	SceneGraph();
+
+	RO5(SceneGraph);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Invalidate
+	// FullName:  SceneGraph::Invalidate
+	// Access:    public
+	// Returns:   void
+	// Description: Sort the hierarchy again before the next propagation, for transforms being added or removed
+	constexpr void Invalidate() noexcept { m_IsStale = true; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    IsStale
+	// FullName:  SceneGraph::IsStale
+	// Access:    public
+	// Returns:   bool
+	// Description: Whether Rebuild has to run first, the transform count is passed in so archetype rows that
+	//		come and go are noticed too. A hierarchy component whose parent isn't the one it got sorted with means reparenting
+	// Parameter: ECS::World * pWorld
+	// Parameter: uint32_t transformCount
+	[[nodiscard]] bool IsStale(ECS::World* pWorld, uint32_t transformCount) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Rebuild
+	// FullName:  SceneGraph::Rebuild
+	// Access:    public
+	// Returns:   void
+	// Description: Resolve the parent of every transform and sort them by depth, the next propagation recomputes all of them
+	// Parameter: ECS::World * pWorld
+	// Parameter: const std::vector<TransformComponent*> & transforms
+	void Rebuild(ECS::World* pWorld, const std::vector<TransformComponent*>& transforms);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Propagate
+	// FullName:  SceneGraph::Propagate
+	// Access:    public
+	// Returns:   void
+	// Description: Recompute the world matrices of the transforms marked changed since the last call and of everything under them
+	// Parameter: ECS::World * pWorld
+	void Propagate(ECS::World* pWorld);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ImGuiDebug
+	// FullName:  SceneGraph::ImGuiDebug
+	// Access:    public
+	// Returns:   void
+	// Description: Node and level count, and what the last propagation recomputed
+	void ImGuiDebug() const;
+
+	[[nodiscard]] inline auto GetNodeCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Transforms.size()); }
+	[[nodiscard]] inline auto GetLevelCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Levels.size()) - 1U; }
+	[[nodiscard]] constexpr auto GetLastRecomputedCount() const noexcept -> uint32_t { return m_LastRecomputedCount; }
+
+private:
+	// Parent index of a root
+	static constexpr uint32_t ROOT = ~0U;
+
+	// Batches bigger than this many jobs worth of nodes are spread over the workers
+	static constexpr uint32_t PARALLEL_BATCH_SIZE = 1024U;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ComputeBatch
+	// FullName:  SceneGraph::ComputeBatch
+	// Access:    private
+	// Returns:   void
+	// Description: World matrices of batch entries [begin, end), the parents are done already
+	// Parameter: uint32_t begin
+	// Parameter: uint32_t end
+	// Parameter: uint32_t tick
+	void ComputeBatch(uint32_t begin, uint32_t end, uint32_t tick);
+
+	// Depth sorted nodes
+	std::vector<TransformComponent*> m_Transforms;
+	std::vector<uint32_t> m_Parents;
+	std::vector<uint32_t> m_Levels; // First node of every depth, plus the end
+	std::vector<XMMATRIX> m_World;
+	std::vector<uint8_t> m_Recomputed;
+
+	// Batch of one level, node index and SoA local transform
+	std::vector<uint32_t> m_Batch;
+	std::vector<XMVECTOR> m_Scales;
+	std::vector<XMVECTOR> m_Rotations;
+	std::vector<XMVECTOR> m_Positions;
+
+	uint32_t m_HierarchyCount;
+	uint32_t m_LastTick;
+	bool m_IsStale;
+	bool m_RecomputeAll;
+
+	// Stats
+	uint32_t m_LastRecomputedCount;
+	float m_LastPropagateTime;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: TransformSystem<uint32_t C, uint32_t I, ExecutionStyle E>
+// Description: World system of the TransformComponent that keeps their world matrices, push it in place
+//		of WorldSystem<TransformComponent, ...>. Its update propagates the hierarchy, the camera and model
+//		renderer read the cached matrices
+// Usage:
+//		m_pWorld->PushSystems<
+//			TransformSystem<TINY, 8, ExecutionStyle::SYNCHRONOUS>,
+//			WorldSystem<HierarchyComponent, TINY, 13, ExecutionStyle::SYNCHRONOUS>
+//		>();
+template<uint32_t C, uint32_t I, ECS::ExecutionStyle E>
+class TransformSystem final
+	: public ECS::WorldSystem<TransformComponent, C, I, E>
+{
+	using Base = ECS::WorldSystem<TransformComponent, C, I, E>;
+
+public:
+	TransformSystem()
+		: m_pWorld(nullptr)
+		, m_Graph()
+	{
+		// Reads the parents and writes back their depth
+		auto access = this->GetAccess();
+		access.writes.push_back(std::type_index(typeid(HierarchyComponent)));
+		this->SetAccess(access);
+	}
+
+	inline ECS::EntityComponent* PushComponent(ECS::Entity* pE) override
+	{
+		m_Graph.Invalidate();
+		return Base::PushComponent(pE);
+	}
+
+	inline void PushComponentBatch(ECS::Entity* const* ppEntities, uint32_t count, ECS::EntityComponent** ppOut) override
+	{
+		m_Graph.Invalidate();
+		Base::PushComponentBatch(ppEntities, count, ppOut);
+	}
+
+	inline void PopComponent(ECS::EntityComponent* pComp) override
+	{
+		m_Graph.Invalidate();
+		Base::PopComponent(pComp);
+	}
+
+	inline void Update([[maybe_unused]] float dt) override
+	{
+		const uint32_t count = this->GetActiveCount();
+
+		if (count == 0U)
+			return;
+
+		if (m_pWorld == nullptr || m_Graph.IsStale(m_pWorld, count))
+		{
+			std::vector<TransformComponent*> transforms{};
+			transforms.reserve(count);
+			this->ForEach([&transforms](TransformComponent& transform) { transforms.push_back(&transform); });
+
+			// Systems don't know their world, the transforms do
+			m_pWorld = transforms[0]->GetOwner()->GetWorld();
+
+			m_Graph.Rebuild(m_pWorld, transforms);
+		}
+
+		m_Graph.Propagate(m_pWorld);
+	}
+
+	// World::SortPools moves transforms between slots and the flat copy points in to the pool,
+	//  the graph has to be stale before the first swap
+	inline bool SwapSlots(uint32_t a, uint32_t b) override
+	{
+		m_Graph.Invalidate();
+		return Base::SwapSlots(a, b);
+	}
+
+	// Restored transforms may have different parents, and the flat copy points in to the pool
+	inline void RestoreSnapshot(ECS::SnapshotReader& reader) override
+	{
+		Base::RestoreSnapshot(reader);
+		m_Graph.Invalidate();
+	}
+
+	inline void ImGuiDebug() override
+	{
+		Base::ImGuiDebug();
+#ifdef DEBUG_POOL
+		m_Graph.ImGuiDebug();
+#endif
+	}
+
+	[[nodiscard]] constexpr auto GetSceneGraph() noexcept -> SceneGraph& { return m_Graph; }
+
+private:
+	ECS::World* m_pWorld;
+	SceneGraph m_Graph;
+};
+
+#endif // !TRANSFORM_SYSTEM_H
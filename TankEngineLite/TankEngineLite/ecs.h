@@ -13,9 +13,13 @@
 #include <typeindex>
 #include <algorithm>
 #include <typeinfo>
+#include <bitset>
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <future>
 #include <vector>
+#include <mutex>
 #include <tuple>
 #include <map>
 
@@ -40,8 +44,16 @@ CLASS_NAME& operator=(CLASS_NAME&&) = delete;
 #ifdef INTE
 #include "Singleton.h"
 #include "Pool.h"
+#include "Snapshot.h"
+#include "Random.h"
+#include "Archetype.h"
+#include "Scheduler.h"
+#include "CommandBuffer.h"
+#include "EventBus.h"
+#include "Query.h"
 #include "Logger.h"
 #include "MemoryTracker.h"
+#include "ThreadPool.h"
 #include "Profiler.h"
 #endif 
 
@@ -59,7 +71,14 @@ class World;
 
 // Contains all type of one Entity Component
 enum ExecutionStyle { SYNCHRONOUS, ASYNCHRONOUS, DYNAMIC, NOEXEC };
-template<typename T, uint32_t C, uint32_t I, ExecutionStyle E>
+
+// How a world system stores its components. FIXED is a Pool of C components that throws once it's full,
+//  PAGED a PagedPool that grows by pages of C components, CONCURRENT a ConcurrentPool of C components
+//  that any number of threads can push to and pop from at once. DENSE a DensePool of C components
+//  packed at the front, popping one moves another and the world repoints everything to it
+enum class PoolStyle { FIXED, PAGED, CONCURRENT, DENSE };
+
+template<typename T, uint32_t C, uint32_t I, ExecutionStyle E, PoolStyle S = PoolStyle::FIXED>
 class WorldSystem;
 
 // An entity inside a world
@@ -77,12 +96,46 @@ public:
 	inline virtual std::type_index GetSystemTypeAsComponent() const = 0;
 	inline virtual ExecutionStyle GetExecutionStyle() const = 0;
 
+	// Component types this system reads and writes while updating, used for scheduling
+	inline virtual const SystemAccess& GetAccess() const = 0;
+	inline virtual void SetAccess(const SystemAccess& access) = 0;
+
 	inline virtual EntityComponent* PushComponent(Entity* pE) = 0;
+	inline virtual void PushComponentBatch(Entity* const* ppEntities, uint32_t count, EntityComponent** ppOut) = 0;
 	inline virtual void PopComponent(EntityComponent* pComp) = 0;
 
 	inline virtual void Update(float dt) = 0;
 	inline virtual void ForAll(std::function<void(EntityComponent*)> execFunc) = 0;
 	inline virtual void ImGuiDebug() = 0;
+
+	// Archetypes holding this system's component type, updated along side the pool
+	inline virtual void AttachArchetype(ArchetypeBase* pArchetype) = 0;
+
+	// ExecutionStyle::DYNAMIC, cost model and splitting of the update over several threads
+	inline virtual DynamicPolicy& GetDynamicPolicy() = 0;
+	inline virtual uint32_t GetActiveCount() const = 0;
+	inline virtual bool CanSplitUpdate() const = 0;
+	inline virtual uint32_t GetRangeCount() const = 0;
+	inline virtual void UpdateRange(float dt, uint32_t range) = 0;
+
+	// Give empty pool pages back, returns how many. Only paged pools have any
+	inline virtual uint32_t TrimPool() = 0;
+
+	// Components that can still be pushed before the pool throws, ~0U for pools that grow
+	inline virtual uint32_t GetFreeSlotCount() const = 0;
+
+	// Pool slots for World::SortPools, components that live in an archetype have POOL_NO_SLOT.
+	//  Swapping leaves the pointers to the two components for the world to fix
+	inline virtual uint32_t GetSlotCount() const = 0;
+	inline virtual uint32_t GetSlot(const EntityComponent* pComponent) const = 0;
+	inline virtual EntityComponent* GetSlotComponent(uint32_t slot) const = 0;
+	inline virtual bool SwapSlots(uint32_t a, uint32_t b) = 0;
+
+	// Pool content to and from a world snapshot, archetypes are handled by the world.
+	//  CanRestore steps over the same part and says whether RestoreSnapshot would get through it
+	inline virtual void SaveSnapshot(WorldSnapshot& snapshot) const = 0;
+	inline virtual bool CanRestore(SnapshotReader& reader) const = 0;
+	inline virtual void RestoreSnapshot(SnapshotReader& reader) = 0;
 };
 
 struct SystemIdentifier
@@ -91,16 +144,61 @@ struct SystemIdentifier
 	uint32_t systemId;
 };
 
+//////////////////////////////////////////////////////////////////////////
+// Class: ComponentTypeId
+// Description: Small dense id per component type, handed out the first time a type asks for one.
+//		Ids are shared by all worlds, each world indexes its flat system table with them
+//		and entities keep a bit per id in their component mask
+class ComponentTypeId
+{
+public:
+	// Component types an entity can hold, one bit each in the entity's component mask
+	static constexpr uint32_t MAX_COUNT = 64U;
+
+	template<typename T>
+	[[nodiscard]] static uint32_t Get()
+	{
+		static const uint32_t id = Register(typeid(T));
+		return id;
+	}
+
+	// Type of an id below MAX_COUNT
+	[[nodiscard]] static std::type_index GetType(uint32_t id) { return std::type_index(*s_pTypes[id]); }
+
+private:
+	static uint32_t Register(const std::type_info& type)
+	{
+		const uint32_t id = s_Next.fetch_add(1U, std::memory_order_relaxed);
+
+		if (id < MAX_COUNT)
+			s_pTypes[id] = &type;
+
+		return id;
+	}
+
+	inline static std::atomic<uint32_t> s_Next{ 0U };
+	inline static const std::type_info* s_pTypes[MAX_COUNT]{};
+};
+
+// Entity ids are handles, the low ENTITY_INDEX_BITS are an index in to the world's entity table and
+//  the rest is the generation of that slot, bumped every time the entity in it gets destroyed.
+//  An id of a destroyed entity never matches the entity that reuses its slot
+constexpr uint32_t ENTITY_INDEX_BITS = 20U;
+constexpr uint32_t ENTITY_INDEX_MASK = (1U << ENTITY_INDEX_BITS) - 1U;
+constexpr uint32_t ENTITY_GENERATION_MASK = (1U << (32U - ENTITY_INDEX_BITS)) - 1U;
+
+// Tag of a new entity, untagged entities aren't in any of the world's tag sets
+constexpr uint32_t ENTITY_NO_TAG = 0U;
+
 //////////////////////////////////////////////////////////////////////////
 class EntityComponent
 {
 public:
-	constexpr EntityComponent() : m_pOwner(nullptr), m_pColliderSystem(nullptr) {}
-	constexpr EntityComponent(Entity* pE) : m_pOwner(pE), m_pColliderSystem(nullptr) {}
+	constexpr EntityComponent() : m_pOwner(nullptr), m_pColliderSystem(nullptr), m_ChangeTick(0U) {}
+	constexpr EntityComponent(Entity* pE) : m_pOwner(pE), m_pColliderSystem(nullptr), m_ChangeTick(0U) {}
 
 	virtual ~EntityComponent() = default;
 	virtual void Update([[maybe_unused]] float dt) { }
-	virtual void OnMessage([[maybe_unused]] uint32_t message) {}
 
 	// System
 	inline void SetSystem(System* pS) { m_pColliderSystem = pS; }
@@ -108,22 +206,126 @@ public:
 	[[nodiscard]] constexpr auto GetOwner() const noexcept -> Entity* { return m_pOwner; }
 	[[nodiscard]] constexpr auto GetSystem() const noexcept -> System* { return m_pColliderSystem; }
 
+	// Change tracking, stamp the component with the world's tick after writing to it.
+	//  Components get stamped when they're pushed on to an entity
+	inline void MarkChanged();
+	[[nodiscard]] constexpr auto GetChangeTick() const noexcept -> uint32_t { return m_ChangeTick; }
+	[[nodiscard]] constexpr auto IsChangedSince(uint32_t tick) const noexcept -> bool { return m_ChangeTick >= tick; }
+
+	// Another component of the entity moved to a new pool slot (World::SortPools, PoolStyle::DENSE), pointers cached to it need patching
+	virtual void OnComponentMoved([[maybe_unused]] const EntityComponent* pFrom, [[maybe_unused]] EntityComponent* pTo) { }
+
 protected:
+	// For OnComponentMoved, repoint pCached if it pointed at the component that moved
+	template<typename T>
+	static inline void Repoint(T*& pCached, const EntityComponent* pFrom, EntityComponent* pTo) noexcept
+	{
+		if (pCached != nullptr && pCached == pFrom)
+			pCached = static_cast<T*>(pTo);
+	}
+
 	Entity* m_pOwner;
 	System* m_pColliderSystem;
+	uint32_t m_ChangeTick;
 };
 
 //////////////////////////////////////////////////////////////////////////
-template<typename T, uint32_t C, uint32_t I, ExecutionStyle E>
-class WorldSystem
+// Class: ComponentSystem<typename T>
+// Description: Typed face of the system holding T, independent of pool size, id and execution style,
+//		so typed iteration can be reached from a System* with a static_cast instead of virtual calls
+template<typename T>
+class ComponentSystem
 	: public System
 {
 public:
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForEach
+	// FullName:  ECS::ComponentSystem<T>::ForEach<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: f(T&) for every active component, pool and archetypes. 
+	//		No std::function and no virtual call per component, f gets inlined in to the loop
+	// Parameter: F&& f
+	template<typename F>
+	void ForEach(F&& f)
+	{
+		// Block by block, by value since f may push a component and add a page
+		for (size_t block = 0U; block < m_pBlocks->size(); ++block)
+		{
+			const PoolBlock<T> poolBlock = (*m_pBlocks)[block];
+			ForAllActiveInBlock(poolBlock, 0U, poolBlock.capacity, [&f](T* pComponent) { f(*pComponent); });
+		}
+
+		ForEachInArchetypes(f);
+	}
+
+protected:
+	template<typename F>
+	void ForEachInArchetypes(F& f)
+	{
+		for (auto pArchetype : m_Archetypes)
+		{
+			pArchetype->ForEachColumnChunk(std::type_index(typeid(T)), [&f](const ArchetypeColumn& column)
+				{
+					T* pColumn = static_cast<T*>(column.pData);
+
+					for (uint32_t i = 0U; i < column.rowCount; ++i)
+					{
+						if (column.pRowMask[i] & column.columnBit)
+							f(pColumn[i]);
+					}
+				});
+		}
+	}
+
+	// Storage of the pool, see PoolBlock
+	const std::vector<PoolBlock<T>>* m_pBlocks = nullptr;
+	std::vector<ArchetypeBase*> m_Archetypes;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: PoolOf<typename T, uint32_t C, PoolStyle S>
+// Description: Pool type behind a world system of the given PoolStyle
+template<typename T, uint32_t C, PoolStyle S>
+struct PoolOf
+{
+	using Type = Pool<T, C>;
+};
+
+template<typename T, uint32_t C>
+struct PoolOf<T, C, PoolStyle::PAGED>
+{
+	using Type = PagedPool<T, C>;
+};
+
+template<typename T, uint32_t C>
+struct PoolOf<T, C, PoolStyle::CONCURRENT>
+{
+	using Type = ConcurrentPool<T, C>;
+};
+
+template<typename T, uint32_t C>
+struct PoolOf<T, C, PoolStyle::DENSE>
+{
+	using Type = DensePool<T, C>;
+};
+
+//////////////////////////////////////////////////////////////////////////
+template<typename T, uint32_t C, uint32_t I, ExecutionStyle E, PoolStyle S>
+class WorldSystem
+	: public ComponentSystem<T>
+{
+public:
+	using ComponentType = T;
+	using PoolType = typename PoolOf<T, C, S>::Type;
+
 	inline WorldSystem()
 		: m_ID(I)
 		, m_ExecutionStyle(E)
+		, m_Access(MakeSystemAccess<T>())
 	{
-		m_pComponentPool = new (Memory::New<Pool<T, C>>()) Pool<T, C>();
+		m_pComponentPool = new (Memory::New<PoolType>()) PoolType();
+		this->m_pBlocks = &m_pComponentPool->GetBlocks();
 	}
 
 	inline ~WorldSystem() override
@@ -136,405 +338,2386 @@ public:
 	[[nodiscard]] constexpr auto GetSystemAsId() const noexcept -> uint32_t { return I; }
 	[[nodiscard]] constexpr auto GetExecutionStyle() const noexcept -> ExecutionStyle override { return m_ExecutionStyle; };
 
+	// System access
+	[[nodiscard]] inline auto GetAccess() const noexcept -> const SystemAccess& override { return m_Access; }
+	inline void SetAccess(const SystemAccess& access) override { m_Access = access; }
+
 	// System management
 	inline EntityComponent* PushComponent(Entity* pE) override
 	{
+		const uint32_t pageCount = m_pComponentPool->GetPageCount();
 		const auto pEc = m_pComponentPool->GetAndInit(pE);
 		pEc->SetSystem(this); // This is not rly idea xd
+
+		if (m_pComponentPool->GetPageCount() != pageCount)
+			ReportGrowth();
+
 		return pEc;
 	}
 
-	inline void PopComponent(EntityComponent* pComp) override
+	// One pass over the pool for the whole batch, component i belongs to ppEntities[i]
+	inline void PushComponentBatch(Entity* const* ppEntities, uint32_t count, EntityComponent** ppOut) override
 	{
-		m_pComponentPool->Pop(static_cast<T*>(pComp));
-	}
+		const uint32_t pageCount = m_pComponentPool->GetPageCount();
 
-	inline void Update(float dt) override
-	{
-		m_pComponentPool->ForAllActive([&](T* pC)
+		m_pComponentPool->GetAndInitBatch(ppEntities, count, [this, ppOut](uint32_t i, T* pEc)
 			{
-				pC->Update(dt);
+				pEc->SetSystem(this);
+				ppOut[i] = pEc;
 			});
+
+		if (m_pComponentPool->GetPageCount() != pageCount)
+			ReportGrowth();
 	}
 
-	inline void ImGuiDebug() override
+	inline void PopComponent(EntityComponent* pComp) override
 	{
-#ifdef DEBUG_POOL
-		std::string str = GetSystemTypeAsComponent().name();
-		str = str.substr(6);
+		if constexpr (S == PoolStyle::DENSE)
+		{
+			// The last component fills the hole, its entity, the entity's components and the queries get told
+			m_pComponentPool->Pop(static_cast<T*>(pComp), [](const T* pFrom, T* pTo)
+				{
+					const auto pOwner = pTo->GetOwner();
+					pOwner->GetWorld()->RelocateComponent(pOwner, ComponentTypeId::Get<T>(), pFrom, pTo);
+				});
+		}
+		else
+			m_pComponentPool->Pop(static_cast<T*>(pComp));
+	}
 
-		if (ImGui::BeginTabItem(str.c_str()))
+	inline void Update(float dt) override
+	{
+#ifdef INTE
+		// Components that opted in get their pool spread over the workers
+		if constexpr (IsParallelUpdate<T>::value)
 		{
-			ImGui::Separator();
-			m_pComponentPool->ImGuiDebugUi();
-			ImGui::EndTabItem();
+			const auto start = std::chrono::high_resolution_clock::now();
+			ParallelForAllActive([dt](T* pC) { pC->T::Update(dt); });
+			m_LastUpdateTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+			return;
 		}
-#endif // DEBUG_POOL
+#endif
+
+		// Qualified call, the pool only holds T so there's no need for the virtual hop
+		CommandScope scope(I, 0U);
+		this->ForEach([dt](T& c) { c.T::Update(dt); });
 	}
 
-	inline void ForAll(std::function<void(EntityComponent*)> execFunc) override
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    UpdateRange
+	// FullName:  ECS::WorldSystem<T, C, I, E, S>::UpdateRange
+	// Access:    public 
+	// Returns:   void
+	// Description: Update the active components of one range of the pool, see PoolBase::RANGE_SIZE.
+	//		Ranges don't overlap so they can run on different threads, archetype columns go with range 0
+	// Parameter: float dt
+	// Parameter: uint32_t range
+	inline void UpdateRange(float dt, uint32_t range) override
+	{
+		ForAllActiveInRange(range, [dt](T* pC) { pC->T::Update(dt); });
+	}
+
+#ifdef INTE
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ParallelForAllActive
+	// FullName:  ECS::WorldSystem<T, C, I, E, S>::ParallelForAllActive
+	// Access:    public 
+	// Returns:   void
+	// Description: ForAll over the engine's workers, f gets called concurrently so it must not
+	//		write to anything but the component it got
+	// Parameter: F&& f
+	template<typename F>
+	inline void ParallelForAllActive(F&& f)
 	{
-		m_pComponentPool->ForAllActive([&](T* pC)
+		// Not worth waking anyone up for a couple of ranges worth of components
+		if (GetActiveCount() < PoolType::RANGE_SIZE * 2U)
+		{
+			for (uint32_t range = 0U; range < GetRangeCount(); ++range)
+				ForAllActiveInRange(range, f);
+
+			return;
+		}
+
+		ThreadPool::GetInstance()->ParallelFor(GetRangeCount(), m_MaxThreads, [this, &f](uint32_t range)
 			{
-				execFunc(pC);
+				ForAllActiveInRange(range, f);
 			});
 	}
+#endif
 
-private:
-	uint32_t m_ID;
-	ExecutionStyle m_ExecutionStyle;
-	Pool<T, C>* m_pComponentPool;
-};
-
-//////////////////////////////////////////////////////////////////////////
-class World
-{
-public:
-	World(uint32_t givenId)
-		: m_ID(givenId)
-		, m_IdCounter(0)
+	inline void AttachArchetype(ArchetypeBase* pArchetype) override
 	{
-#ifdef ECS_LOG
-#ifdef INTE
-		Logger::GetInstance()->Log<LOG_SUCCESS>("World created");
-#endif
-#endif
+		this->m_Archetypes.push_back(pArchetype);
 	}
 
-	~World();
-
-	[[nodiscard]] Entity* CreateEntity();
-	inline void MessageAll(uint32_t message);
+	// Dynamic execution
+	[[nodiscard]] inline auto GetDynamicPolicy() noexcept -> DynamicPolicy& override { return m_DynamicPolicy; }
+	[[nodiscard]] constexpr auto CanSplitUpdate() const noexcept -> bool override { return IsParallelUpdate<T>::value; }
+	[[nodiscard]] inline auto GetRangeCount() const noexcept -> uint32_t override { return m_pComponentPool->GetRangeCount(); }
 
-	void AsyncCreateEntity(std::function<void(Entity*)> initializer)
+	inline uint32_t TrimPool() override
 	{
-		// TODO(tomas): not thread safe
-		m_AsyncCreationBuffer.push_back(initializer);
+		if constexpr (S == PoolStyle::PAGED)
+			return m_pComponentPool->Trim();
+		else
+			return 0U;
 	}
 
-	inline void DestroyEntity(uint32_t id);
-	inline void AsyncDestroyEntity(uint32_t id)
+	[[nodiscard]] inline uint32_t GetFreeSlotCount() const override
 	{
-		// TODO(tomas): not thread safe
-		m_AsyncDestroyBuffer.push_back(id);
+		if constexpr (S == PoolStyle::PAGED)
+			return ~0U;
+		else
+			return m_pComponentPool->GetCapacity() - m_pComponentPool->GetActiveCount();
 	}
 
+	[[nodiscard]] inline uint32_t GetSlotCount() const override { return m_pComponentPool->GetSlotCount(); }
+	[[nodiscard]] inline uint32_t GetSlot(const EntityComponent* pComponent) const override { return m_pComponentPool->IndexOf(static_cast<const T*>(pComponent)); }
+	[[nodiscard]] inline EntityComponent* GetSlotComponent(uint32_t slot) const override { return m_pComponentPool->GetActive(slot); }
+	inline bool SwapSlots(uint32_t a, uint32_t b) override { return m_pComponentPool->Swap(a, b); }
 
-	//////////////////////////////////////
-	// Push Systems impl
-private:
-	template<typename T>
-	constexpr T* PushSystem()
+	[[nodiscard]] inline auto GetActiveCount() const noexcept -> uint32_t override
 	{
-		auto typeIndex = std::type_index(typeid(T));
+		uint32_t count = m_pComponentPool->GetActiveCount();
 
-		// Create world
-		auto pWorldSystem = new (Memory::New<T>()) T();
+		for (auto pArchetype : this->m_Archetypes)
+			count += pArchetype->GetActiveCount();
 
-		// Create system identifier
-		SystemIdentifier system;
-		system.pSystem = static_cast<System*>(pWorldSystem);
-		system.systemId = pWorldSystem->GetSystemAsId();
+		return count;
+	}
 
-		// Store it linked to the EntityComponent type of the system
-		m_Systems[pWorldSystem->GetSystemTypeAsComponent()] = system;
+	inline void ImGuiDebug() override
+	{
+#ifdef DEBUG_POOL
+		std::string str = GetSystemTypeAsComponent().name();
+		str = str.substr(6);
+
+		if (ImGui::BeginTabItem(str.c_str()))
+		{
+			ImGui::Separator();
 
-#ifdef ECS_LOG
 #ifdef INTE
-		std::stringstream stream;
-		stream << "Registered world system : " + std::string(typeIndex.name());
-		Logger::GetInstance()->Log<LOG_INFO>(stream.str());
-#endif
+			// Live scaling of the parallel update, drag the thread count and watch the update time
+			if (CanSplitUpdate())
+			{
+				int maxThreads = (m_MaxThreads == 0U) ? static_cast<int>(THREADPOOL->GetWorkerCount() + 1U) : static_cast<int>(m_MaxThreads);
+				
+				if (ImGui::SliderInt("Threads", &maxThreads, 1, static_cast<int>(THREADPOOL->GetWorkerCount() + 1U)))
+					m_MaxThreads = static_cast<uint32_t>(maxThreads);
+
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Update time: ");
+				ImGui::SameLine();
+				ImGui::Text("%.3f ms", m_LastUpdateTime * 1000.f);
+				ImGui::Separator();
+			}
 #endif
-		return pWorldSystem;
+
+			if constexpr (S == PoolStyle::PAGED)
+			{
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Pages: ");
+				ImGui::SameLine();
+				ImGui::Text("%u pages of %u slots, grown %u times", m_pComponentPool->GetPageCount(), C, m_GrowthCount);
+			}
+
+			m_pComponentPool->ImGuiDebugUi();
+
+			for (auto pArchetype : this->m_Archetypes)
+			{
+				ImGui::NewLine();
+				pArchetype->ImGuiDebugUi();
+			}
+
+			ImGui::EndTabItem();
+		}
+#endif // DEBUG_POOL
 	}
 
-public:
-	template<typename... T>
-	constexpr std::tuple<T* ...> PushSystems()
+	inline void ForAll(std::function<void(EntityComponent*)> execFunc) override
 	{
-		return std::tuple<T * ...> { PushSystem<T>()... };
+		this->ForEach([&execFunc](T& c) { execFunc(&c); });
 	}
 
-public:
-	template<typename T>
-	[[nodiscard]] constexpr System* GetSystemByComponent() const
+	// Look up table and the whole pool block, see WorldSnapshot::WriteColumn.
+	//  Paged pools store the address of every page in use first and then each of those like a pool block
+	inline void SaveSnapshot(WorldSnapshot& snapshot) const override
 	{
-		// Find system of type T
-		auto type = std::type_index(typeid(T));
-		auto found = std::find_if(m_Systems.begin(), m_Systems.end(),
-			[&](auto sys)
+		const auto pPool = m_pComponentPool;
+		snapshot.WriteValue(pPool->GetActiveCount());
+
+		if constexpr (S == PoolStyle::PAGED)
+		{
+			const auto& blocks = pPool->GetBlocks();
+			std::vector<uint64_t> addresses(blocks.size(), 0U);
+
+			// Empty pages are left out, trimming them doesn't stop the snapshot from being restored
+			for (uint32_t page = 0U; page < blocks.size(); ++page)
 			{
-				return (sys.second.pSystem->GetSystemTypeAsComponent() == type);
-			});
+				if (blocks[page].pItems != nullptr && pPool->GetPageActiveCount(page) != 0U)
+					addresses[page] = reinterpret_cast<uint64_t>(blocks[page].pItems);
+			}
 
-		System* pS = nullptr;
+			snapshot.WriteVector(addresses);
 
-		// If found, return it
-		if (found != m_Systems.end())
-			pS = found->second.pSystem;
+			for (uint32_t page = 0U; page < blocks.size(); ++page)
+			{
+				if (addresses[page] == 0U)
+					continue;
 
-		return pS;
+				const uint32_t first = page * C;
+				snapshot.Write(blocks[page].pLookUp, C / 8U);
+				snapshot.WriteColumn(blocks[page].pItems, C, [pPool, first](uint32_t i) { return pPool->IsActive(first + i); });
+			}
+		}
+		else
+		{
+			snapshot.Write(pPool->GetLookUp(), C / 8U);
+			snapshot.WriteColumn(pPool->GetPool(), C, [pPool](uint32_t i) { return pPool->IsActive(i); });
+		}
 	}
 
-public:
-	void Update(float dt)
+	// Same walk as RestoreSnapshot without touching the pool, false once a page the snapshot used got trimmed
+	inline bool CanRestore(SnapshotReader& reader) const override
 	{
-		std::vector<std::future<void>> futures{};
+		reader.Read(sizeof(uint32_t));
 
-		// TODO(tomas): Each async system owns a thread that is waiting for 
-		//  the go ahead signal to do another loop
-		//  Right now, we create an async ting every time, not good 
-		// TODO(tomas): ExecutionStyle::DYNAMIC, let ECS decide, at runtime
-		//  which execution policy it should take
-		
-		// Async system threads launched
-		for (auto system : m_Systems)
+		if constexpr (S == PoolStyle::PAGED)
 		{
-			const auto pSystem = system.second.pSystem;
+			std::vector<uint64_t> addresses{};
+			reader.ReadVector(addresses);
 
-			if (pSystem->GetExecutionStyle() == ExecutionStyle::ASYNCHRONOUS)
-				futures.push_back(std::async(std::launch::async, &System::Update, pSystem, dt));
-		}
+			// Entities point in to the pages, every page the snapshot had must still be where it was
+			const auto& blocks = m_pComponentPool->GetBlocks();
+			for (uint32_t page = 0U; page < addresses.size(); ++page)
+			{
+				if (addresses[page] == 0U)
+					continue;
 
-		// Do normal updating
-		for (auto system : m_Systems)
-		{
-			const auto pSystem = system.second.pSystem;
+				if (page >= blocks.size() || reinterpret_cast<uint64_t>(blocks[page].pItems) != addresses[page])
+					return false;
 
-			if (pSystem->GetExecutionStyle() == ExecutionStyle::SYNCHRONOUS)
-				pSystem->Update(dt);
+				reader.Read(C / 8U);
+				reader.SkipColumn<T>(C);
+			}
+		}
+		else
+		{
+			reader.Read(C / 8U);
+			reader.SkipColumn<T>(C);
 		}
 
-		// Cleanup futures
-		Profiler::GetInstance()->BeginSubSession<SESSION_THREAD_WAITING>();
-		for (auto& f : futures)
-			f.get();
-		Profiler::GetInstance()->EndSubSession();
-
-		// Process async destructions
-		for (uint32_t i : m_AsyncDestroyBuffer)
-			DestroyEntity(i);
-
-		// Process async insertions
-		for (auto& asyncCreator : m_AsyncCreationBuffer)
-			asyncCreator(CreateEntity());
-
-		m_AsyncDestroyBuffer.clear();
-		m_AsyncCreationBuffer.clear();
+		return true;
 	}
 
-	void ImGuiDebug()
+	inline void RestoreSnapshot(SnapshotReader& reader) override
 	{
-#ifdef DEBUG_POOL
-		std::string str = "World: " + std::to_string(m_ID) + " system debugger";
-		ImGui::Begin(str.c_str());
-		if (ImGui::BeginTabBar("World Systems", ImGuiTabBarFlags_None))
+		const auto pPool = m_pComponentPool;
+		const uint32_t activeCount = reader.ReadValue<uint32_t>();
+
+		if constexpr (S == PoolStyle::PAGED)
 		{
-			if (ImGui::BeginTabItem("World stats"))
-			{
-				ImGui::Separator();
+			// CanRestore checked the pages already, this only guards callers that skip it
+			std::vector<uint64_t> addresses{};
+			reader.ReadVector(addresses);
 
-				// World Id
-				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "World id: ");
-				ImGui::SameLine();
-				ImGui::Text(std::to_string(m_ID).c_str());
+			const auto& blocks = pPool->GetBlocks();
+			for (uint32_t page = 0U; page < addresses.size(); ++page)
+			{
+				if (addresses[page] != 0U && (page >= blocks.size() || reinterpret_cast<uint64_t>(blocks[page].pItems) != addresses[page]))
+					throw std::exception("Snapshot uses pool pages that have been trimmed since");
+			}
 
-				// System count
-				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Entity count: ");
-				ImGui::SameLine();
-				ImGui::Text(std::to_string(m_pEntities.size()).c_str());
+			pPool->Clear();
 
-				// Id counter
-				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "UID counter: ");
-				ImGui::SameLine();
-				ImGui::Text(std::to_string(m_IdCounter).c_str());
+			for (uint32_t page = 0U; page < addresses.size(); ++page)
+			{
+				if (addresses[page] == 0U)
+					continue;
 
-				// Entity count
-				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Component system count: ");
-				ImGui::SameLine();
-				ImGui::Text(std::to_string(m_Systems.size()).c_str());
+				const uint32_t first = page * C;
+				const auto pLookUp = reinterpret_cast<const char*>(reader.Read(C / 8U));
 
-				ImGui::EndTabItem();
+				pPool->RestorePage(page, pLookUp, [&reader, pPool, first](T* pItems)
+					{
+						reader.ReadColumn(pItems, C, [pPool, first](uint32_t i) { return pPool->IsActive(first + i); });
+					});
 			}
-#endif
-			for (auto system : m_Systems)
-				system.second.pSystem->ImGuiDebug();
-#ifdef DEBUG_POOL
-			ImGui::EndTabBar();
+
+			if (pPool->GetActiveCount() != activeCount)
+				throw std::exception("Snapshot is corrupt");
+		}
+		else
+		{
+			const auto pLookUp = reinterpret_cast<const char*>(reader.Read(C / 8U));
+
+			pPool->Restore(pLookUp, activeCount, [&reader, pPool](T* pItems)
+				{
+					reader.ReadColumn(pItems, C, [pPool](uint32_t i) { return pPool->IsActive(i); });
+				});
 		}
-		ImGui::End();
-#endif
 	}
 
 private:
-	uint32_t m_ID;
-	uint32_t m_IdCounter;
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForAllActiveInRange
+	// FullName:  ECS::WorldSystem<T, C, I, E, S>::ForAllActiveInRange
+	// Access:    private 
+	// Returns:   void
+	// Description: For all active components in one range of the pool, range 0 also covers the archetypes
+	// Parameter: uint32_t range
+	// Parameter: F&& f
+	template<typename F>
+	inline void ForAllActiveInRange(uint32_t range, F&& f)
+	{
+		// A range is only ever run by one thread, key the commands it records on it
+		CommandScope scope(I, range + 1U);
 
-	std::unordered_map<uint32_t, Entity*> m_pEntities;
-	std::unordered_map<std::type_index, SystemIdentifier> m_Systems;
+		const uint32_t begin = range * PoolType::RANGE_SIZE;
+		m_pComponentPool->ForAllActiveInRange(begin, begin + PoolType::RANGE_SIZE, f);
 
-	std::vector<uint32_t> m_AsyncDestroyBuffer;
-	std::vector<std::function<void(Entity*)>> m_AsyncCreationBuffer;
-};
+		if (range != 0U)
+			return;
 
-//////////////////////////////////////////////////////////////////////////
-class Entity final
-{
-public:
+		auto typed = [&f](T& c) { f(&c); };
+		this->ForEachInArchetypes(typed);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ReportGrowth
+	// FullName:  ECS::WorldSystem<T, C, I, E, S>::ReportGrowth
+	// Access:    private 
+	// Returns:   void
+	// Description: A push added pages to the pool, count it for the debug ui and log the new size
+	inline void ReportGrowth()
+	{
+		++m_GrowthCount;
+
+#ifdef ECS_LOG
+#ifdef INTE
+		std::stringstream stream;
+		stream << "Pool of " << typeid(T).name() << " grew to " << m_pComponentPool->GetPageCount()
+			<< " pages, " << m_pComponentPool->GetCapacity() << " slots";
+		Logger::GetInstance()->Log<LOG_INFO>(stream.str());
+#endif
+#endif
+	}
+
+	uint32_t m_ID;
+	ExecutionStyle m_ExecutionStyle;
+	SystemAccess m_Access;
+	DynamicPolicy m_DynamicPolicy;
+	uint32_t m_MaxThreads = 0U;
+	float m_LastUpdateTime = 0.f;
+	uint32_t m_GrowthCount = 0U;
+	PoolType* m_pComponentPool;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Class: Prefab<typename... T>
+// Description: Component layout spawned by World::SpawnBatch, plus the default values every
+//		entity gets before its initializer runs. The layout is checked once, when the prefab is built.
+//		Like with PushComponents, components are constructed from the last type to the first,
+//		a constructor can look up the ones listed after it
+// Usage:
+//		static const ECS::Prefab<Particle> particlePrefab{};
+//		pWorld->SpawnBatch(particlePrefab, 100U, [](ECS::Entity* pEntity, Particle* pParticle) { ... });
+template<typename... T>
+class Prefab
+{
+	static_assert(sizeof...(T) > 0, "A prefab needs at least one component type");
+
+public:
+	Prefab()
+		: Prefab(nullptr)
+	{
+	}
+
+	explicit Prefab(std::function<void(T*...)> defaults)
+		: m_Defaults(std::move(defaults))
+		, m_ComponentMask(0U)
+	{
+		const uint32_t typeIds[] = { ComponentTypeId::Get<T>()... };
+
+		for (uint32_t typeId : typeIds)
+		{
+			if (typeId >= ComponentTypeId::MAX_COUNT)
+				throw std::exception("Too many component types for the entity component mask");
+
+			if (m_ComponentMask & (1ULL << typeId))
+				throw std::exception("Prefab lists the same component type twice");
+
+			m_ComponentMask |= (1ULL << typeId);
+		}
+	}
+
+	inline void ApplyDefaults(T*... pComponents) const
+	{
+		if (m_Defaults)
+			m_Defaults(pComponents...);
+	}
+
+	[[nodiscard]] constexpr auto GetComponentMask() const noexcept -> uint64_t { return m_ComponentMask; }
+
+private:
+	std::function<void(T*...)> m_Defaults;
+	uint64_t m_ComponentMask;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Struct: Changed<typename T>
+// Description: Query filter for World::ForEach, only matches entities whose T got marked 
+//		changed during this world update or the previous one. The callback still gets a T&
+// Usage:
+//		pWorld->ForEach<Changed<TransformComponent2D>, SpriteRenderComponent>(
+//			[](TransformComponent2D& transform, SpriteRenderComponent& render) { ... });
+template<typename T>
+struct Changed {};
+
+// Component type of a ForEach argument and whether it's filtered on changes
+template<typename Q>
+struct QueryTerm
+{
+	using Component = Q;
+	static constexpr bool ChangedOnly = false;
+};
+
+template<typename T>
+struct QueryTerm<Changed<T>>
+{
+	using Component = T;
+	static constexpr bool ChangedOnly = true;
+};
+
+//////////////////////////////////////////////////////////////////////////
+class World
+{
+	// Entities tell the queries about their component changes
+	friend class Entity;
+
+	// Dense pools move a component whenever another one gets popped
+	template<typename T, uint32_t C, uint32_t I, ExecutionStyle E, PoolStyle S>
+	friend class WorldSystem;
+
+public:
+	World(uint32_t givenId)
+		: m_ID(givenId)
+		, m_ScheduleDirty(true)
+	{
+#ifdef INTE
+		// One command buffer per engine thread, recording from those never locks
+		m_ThreadCommands.resize(ThreadPool::GetInstance()->GetWorkerCount() + 1U);
+#endif
+
+#ifdef ECS_LOG
+#ifdef INTE
+		Logger::GetInstance()->Log<LOG_SUCCESS>("World created");
+#endif
+#endif
+	}
+
+	~World();
+
+	[[nodiscard]] Entity* CreateEntity();
+
+	// Destroying an entity that is already gone does nothing, ids are checked against the slot's generation
+	inline void DestroyEntity(uint32_t id);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Deferred structural changes, safe to call from any thread while the systems update.
+	//  Applied at the end of World::Update: component changes first, then destroys, then creations,
+	//  every group in an order that doesn't depend on which thread recorded what
+	void AsyncCreateEntity(std::function<void(Entity*)> initializer)
+	{
+		RecordCommand([&initializer](CommandBuffer& buffer) { buffer.Create(std::move(initializer)); });
+	}
+
+	// Destroying the same entity several times in a frame is fine, duplicates are collapsed
+	inline void AsyncDestroyEntity(uint32_t id)
+	{
+		RecordCommand([id](CommandBuffer& buffer) { buffer.Destroy(id); });
+	}
+
+	// Skipped when the entity is gone by the time the commands get applied
+	void AsyncModifyEntity(uint32_t id, std::function<void(Entity*)> func)
+	{
+		RecordCommand([id, &func](CommandBuffer& buffer) { buffer.Modify(id, std::move(func)); });
+	}
+
+	template<typename... T>
+	inline void AsyncPushComponents(uint32_t id);
+
+	template<typename... T>
+	inline void AsyncPopComponents(uint32_t id);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SpawnBatch
+	// FullName:  ECS::World::SpawnBatch<typename... T, typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Create count entities with the components of the prefab. Entity slots are reserved
+	//		up front and every component type takes all its slots in one pass over its pool, then 
+	//		initializer(Entity*, T*...) runs for every entity after the prefab's defaults.
+	//		Main thread only, see AsyncSpawnBatch
+	// Parameter: const Prefab<T...> & prefab
+	// Parameter: uint32_t count
+	// Parameter: F&& initializer
+	template<typename... T, typename F>
+	inline void SpawnBatch(const Prefab<T...>& prefab, uint32_t count, F&& initializer);
+
+	// Deferred SpawnBatch, the batch is applied with the other creations
+	template<typename... T, typename F>
+	void AsyncSpawnBatch(const Prefab<T...>& prefab, uint32_t count, F&& initializer)
+	{
+		RecordCommand([&](CommandBuffer& buffer)
+			{
+				buffer.SpawnBatch([this, prefab, count, initializer = std::forward<F>(initializer)](Entity*) 
+					{ 
+						SpawnBatch(prefab, count, initializer); 
+					});
+			});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Subscribe
+	// FullName:  ECS::World::Subscribe<typename E, typename T>
+	// Access:    public 
+	// Returns:   void
+	// Description: Components T get events of type E through a `void OnEvent(const E&)` member,
+	//		all events of a frame are handed to them in one batch once the systems are done updating.
+	//		Subscribe while setting up the world, events nobody subscribed to are dropped
+	template<typename E, typename T>
+	void Subscribe()
+	{
+		const uint32_t eventId = EventTypeId::Get<E>();
+
+		if (eventId >= m_EventQueues.size())
+			m_EventQueues.resize(eventId + 1U, nullptr);
+
+		if (!m_EventQueues[eventId])
+			m_EventQueues[eventId] = new (Memory::New<EventQueue<E>>()) EventQueue<E>(static_cast<uint32_t>(m_ThreadCommands.size()));
+
+		static_cast<EventQueue<E>*>(m_EventQueues[eventId])->Subscribe(&World::DeliverEvents<E, T>);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Sending events, safe from any thread. Delivered at the end of World::Update, 
+	//  events sent while delivering are delivered the next frame
+	template<typename E>
+	inline void SendEvent(uint32_t entityId, const E& event) { PushEvent(entityId, EVENT_ALL_TAGS, event); }
+
+	// To the subscribers on every entity with the tag
+	template<typename E>
+	inline void SendEventToTag(uint32_t tag, const E& event) { PushEvent(EVENT_NO_ENTITY, tag, event); }
+
+	template<typename E>
+	inline void SendEventToAll(const E& event) { PushEvent(EVENT_NO_ENTITY, EVENT_ALL_TAGS, event); }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetEntity
+	// FullName:  ECS::World::GetEntity
+	// Access:    public 
+	// Returns:   Entity*
+	// Qualifier: const
+	// Description: Entity of the given id, nullptr when it was destroyed
+	// Parameter: uint32_t id
+	[[nodiscard]] inline Entity* GetEntity(uint32_t id) const;
+	[[nodiscard]] inline bool IsAlive(uint32_t id) const { return GetEntity(id) != nullptr; }
+	[[nodiscard]] inline auto GetEntityCount() const noexcept -> size_t { return m_Entities.size(); }
+	[[nodiscard]] constexpr auto GetId() const noexcept -> uint32_t { return m_ID; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    CaptureSnapshot
+	// FullName:  ECS::World::CaptureSnapshot
+	// Access:    public 
+	// Returns:   void
+	// Description: Write the entity table and the storage of every system and archetype in to the snapshot.
+	//		Main thread only and outside of Update, commands and events still queued are not part of it
+	// Parameter: WorldSnapshot & snapshot
+	inline void CaptureSnapshot(WorldSnapshot& snapshot) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RestoreSnapshot
+	// FullName:  ECS::World::RestoreSnapshot
+	// Access:    public 
+	// Returns:   void
+	// Description: Put the world back in the state it was captured in, everything alive now gets destroyed
+	//		and queued commands and events are dropped. Main thread only and outside of Update.
+	//		Ids handed out after the capture may match the restored entities, drop them.
+	//		Snapshots whose storage doesn't fit the pools and archetypes throw before anything is touched
+	// Parameter: const WorldSnapshot & snapshot
+	inline void RestoreSnapshot(const WorldSnapshot& snapshot);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    TrimPools
+	// FullName:  ECS::World::TrimPools
+	// Access:    public 
+	// Returns:   uint32_t
+	// Description: Give the empty pages of every paged pool back to the allocator, returns how many.
+	//		Snapshots taken before that had components on those pages can't be restored anymore, RestoreSnapshot
+	//		throws on them and leaves the world as it is. Main thread only and outside of Update
+	inline uint32_t TrimPools();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    CoSortPools
+	// FullName:  ECS::World::CoSortPools<typename Leader, typename Follower>
+	// Access:    public 
+	// Returns:   void
+	// Description: Have SortPools move the Follower of every entity to the pool slot its Leader is in,
+	//		so a pass over the Follower pool that reads the Leader walks both in the same order.
+	//		The Leader pool never moves, a pool can only follow one other pool
+	// Usage:
+	//		m_pWorld->CoSortPools<TransformComponent2D, SpriteRenderComponent>();
+	template<typename Leader, typename Follower>
+	inline void CoSortPools();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SortPools
+	// FullName:  ECS::World::SortPools
+	// Access:    public 
+	// Returns:   uint32_t
+	// Description: Look at up to slotBudget Leader slots of every CoSortPools pair, continuing where the
+	//		last call stopped, and move the Followers that are out of place. Moved components are patched
+	//		in their entity, its components (EntityComponent::OnComponentMoved) and the queries.
+	//		Returns how many components moved. Main thread only and outside of Update, meant for idle frames
+	// Parameter: uint32_t slotBudget
+	inline uint32_t SortPools(uint32_t slotBudget);
+
+	//////////////////////////////////////
+	// Push Systems impl
+private:
+	template<typename T>
+	constexpr T* PushSystem()
+	{
+		auto typeIndex = std::type_index(typeid(T));
+
+		// Create world
+		auto pWorldSystem = new (Memory::New<T>()) T();
+
+		// Create system identifier
+		SystemIdentifier system;
+		system.pSystem = static_cast<System*>(pWorldSystem);
+		system.systemId = pWorldSystem->GetSystemAsId();
+
+		// Store it linked to the EntityComponent type of the system
+		m_Systems[pWorldSystem->GetSystemTypeAsComponent()] = system;
+		m_ScheduleDirty = true;
+
+		// And in the flat table for typed look ups
+		const uint32_t typeId = ComponentTypeId::Get<typename T::ComponentType>();
+
+		if (typeId >= m_SystemTable.size())
+			m_SystemTable.resize(typeId + 1U, nullptr);
+
+		m_SystemTable[typeId] = system.pSystem;
+
+#ifdef ECS_LOG
+#ifdef INTE
+		std::stringstream stream;
+		stream << "Registered world system : " + std::string(typeIndex.name());
+		Logger::GetInstance()->Log<LOG_INFO>(stream.str());
+#endif
+#endif
+		return pWorldSystem;
+	}
+
+public:
+	template<typename... T>
+	constexpr std::tuple<T* ...> PushSystems()
+	{
+		return std::tuple<T * ...> { PushSystem<T>()... };
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetSystemAccess
+	// FullName:  ECS::World::SetSystemAccess<typename T, typename R, typename W>
+	// Access:    public 
+	// Returns:   void
+	// Description: Declare what the system of component T reads (R) and writes (W), 
+	//		overrides the ReadSet/WriteSet declared on the component. 
+	//		Usage: SetSystemAccess<LifeSpan, ComponentSet<>, ComponentSet<>>();
+	template<typename T, typename R, typename W>
+	void SetSystemAccess()
+	{
+		auto pSystem = GetSystemByComponent<T>();
+
+		if (!pSystem)
+			return;
+
+		SystemAccess access{};
+		access.reads = R::ToTypes();
+		access.writes = W::ToTypes();
+		access.writes.push_back(std::type_index(typeid(T)));
+		access.exclusive = false;
+
+		pSystem->SetAccess(access);
+		m_ScheduleDirty = true;
+	}
+
+	//////////////////////////////////////
+	// Push Archetypes impl
+private:
+	template<typename T>
+	T* PushArchetype()
+	{
+		auto pArchetype = new (Memory::New<T>()) T();
+		m_Archetypes.push_back(pArchetype);
+
+		// Let the systems of every column know, so the components still get updated
+		for (const auto& type : pArchetype->GetSignature())
+		{
+			auto found = m_Systems.find(type);
+
+			if (found != m_Systems.end())
+				found->second.pSystem->AttachArchetype(pArchetype);
+#ifdef ECS_LOG
+#ifdef INTE
+			else
+				Logger::GetInstance()->Log<LOG_WARNING>("Archetype column without a world system : " + std::string(type.name()));
+#endif
+#endif
+		}
+
+		return pArchetype;
+	}
+
+public:
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    PushArchetypes
+	// FullName:  ECS::World::PushArchetypes<typename... T>
+	// Access:    public 
+	// Returns:   std::tuple<T* ...>
+	// Description: Register archetypes, entities created with exactly the component set of 
+	//		an archetype get stored in its chunks instead of the system pools.
+	//		Push the world systems first
+	template<typename... T>
+	std::tuple<T* ...> PushArchetypes()
+	{
+		return std::tuple<T * ...> { PushArchetype<T>()... };
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetArchetype
+	// FullName:  ECS::World::GetArchetype<typename... T>
+	// Access:    public 
+	// Returns:   ArchetypeBase*
+	// Description: Get the archetype with the component set T..., nullptr if there is none
+	template<typename... T>
+	[[nodiscard]] ArchetypeBase* GetArchetype() const
+	{
+		if (m_Archetypes.empty())
+			return nullptr;
+
+		static const auto signature = MakeArchetypeSignature<T...>();
+
+		for (auto pArchetype : m_Archetypes)
+		{
+			if (pArchetype->GetSignature() == signature)
+				return pArchetype;
+		}
+
+		return nullptr;
+	}
+
+public:
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetSystemByComponent
+	// FullName:  ECS::World::GetSystemByComponent<typename T>
+	// Access:    public 
+	// Returns:   System*
+	// Qualifier: const
+	// Description: System holding components of type T, nullptr if the world has none. 
+	//		One indexed load in to the flat system table
+	template<typename T>
+	[[nodiscard]] System* GetSystemByComponent() const
+	{
+		const uint32_t typeId = ComponentTypeId::Get<T>();
+		return (typeId < m_SystemTable.size()) ? m_SystemTable[typeId] : nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForEach
+	// FullName:  ECS::World::ForEach<typename T, typename... Ts, typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: Typed query, f(T&, Ts&...) for every entity that has all of the components.
+	//		Walks the system of T directly, the other components get looked up on the owner.
+	//		Any of the types can be wrapped in Changed<> to skip entities where it didn't change
+	// Parameter: F&& f
+	// Usage:
+	//		pWorld->ForEach<TransformComponent2D, SpriteRenderComponent>(
+	//			[](TransformComponent2D& transform, SpriteRenderComponent& render) { ... });
+	template<typename Q, typename... Qs, typename F>
+	void ForEach(F&& f)
+	{
+		using T = typename QueryTerm<Q>::Component;
+		const auto pSystem = static_cast<ComponentSystem<T>*>(GetSystemByComponent<T>());
+
+		if (!pSystem)
+			return;
+
+		if constexpr ((QueryTerm<Q>::ChangedOnly || ... || QueryTerm<Qs>::ChangedOnly))
+		{
+			// Changed during the last update or this one so far
+			const uint32_t since = m_ChangeTick - 1U;
+
+			pSystem->ForEach([&f, since](T& c)
+				{
+					if (!IsQueryMatch<Q>(&c, since))
+						return;
+
+					const auto components = c.GetOwner()->template GetComponents<typename QueryTerm<Qs>::Component...>();
+
+					if ((IsQueryMatch<Qs>(std::get<typename QueryTerm<Qs>::Component*>(components), since) && ...))
+						f(c, *std::get<typename QueryTerm<Qs>::Component*>(components)...);
+				});
+		}
+		else if constexpr (sizeof...(Qs) == 0)
+			pSystem->ForEach(f);
+		else
+		{
+			pSystem->ForEach([&f](T& c)
+				{
+					const auto components = c.GetOwner()->template GetComponents<Qs...>();
+
+					if ((std::get<Qs*>(components) && ...))
+						f(c, *std::get<Qs*>(components)...);
+				});
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetQuery
+	// FullName:  ECS::World::GetQuery<typename... T>
+	// Access:    public 
+	// Returns:   Query<T...>*
+	// Description: Cached query of the entities holding all of T, built with one pass over the entities
+	//		the first time and kept up to date as components get pushed and popped from then on.
+	//		Lives as long as the world, from the thread the entities are changed on
+	template<typename... T>
+	[[nodiscard]] inline Query<T...>* GetQuery();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetTagged
+	// FullName:  ECS::World::GetTagged
+	// Access:    public 
+	// Returns:   const std::vector<Entity*>&
+	// Qualifier: const
+	// Description: Every entity with the tag, in no particular order. Kept up to date by Entity::SetTag and
+	//		destroying entities, so asking for a tag only costs the entities that have it
+	// Parameter: uint32_t tag
+	[[nodiscard]] inline const std::vector<Entity*>& GetTagged(uint32_t tag) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ForEachTagged
+	// FullName:  ECS::World::ForEachTagged<typename F>
+	// Access:    public 
+	// Returns:   void
+	// Description: f(Entity*) for every entity with the tag. The entity being visited can be destroyed or retagged,
+	//		entities tagged by then aren't visited until the next call
+	// Usage:
+	//		m_pWorld->ForEachTagged(Tags::PLAYER, [](ECS::Entity* pPlayer) { ... });
+	// Parameter: uint32_t tag
+	// Parameter: F && f
+	template<typename F>
+	void ForEachTagged(uint32_t tag, F&& f)
+	{
+		const auto it = m_TagSets.find(tag);
+
+		if (it == m_TagSets.end())
+			return;
+
+		const auto& entities = it->second;
+
+		for (size_t i = entities.size(); i > 0U; --i)
+		{
+			// Same as the queries, f can take out entities behind the current one
+			if (i > entities.size())
+				continue;
+
+			f(entities[i - 1U]);
+		}
+	}
+
+	// Ticks once at the start of every update, what EntityComponent::MarkChanged stamps components with
+	[[nodiscard]] constexpr auto GetChangeTick() const noexcept -> uint32_t { return m_ChangeTick; }
+
+	// Random numbers for gameplay, part of the snapshots. Only from the thread updating the world (deferred commands
+	//  run there too), draws from the async systems would come out in a different order every run
+	[[nodiscard]] constexpr auto GetRandom() noexcept -> Random& { return m_Random; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetIndependent
+	// FullName:  ECS::World::SetIndependent
+	// Access:    public 
+	// Returns:   void
+	// Description: An independent world shares no state with other worlds or the game, Universe::Update
+	//		runs it on a worker in parallel with the other independent worlds. Its systems, event handlers
+	//		and deferred commands then run off the main thread
+	// Parameter: bool isIndependent
+	constexpr void SetIndependent(bool isIndependent) noexcept { m_IsIndependent = isIndependent; }
+	[[nodiscard]] constexpr auto IsIndependent() const noexcept -> bool { return m_IsIndependent; }
+
+public:
+	void Update(float dt)
+	{
+		++m_ChangeTick;
+
+#ifdef INTE
+		// Async systems go to the engine's persistent workers
+		JobGroup asyncSystems{};
+		const auto pThreadPool = ThreadPool::GetInstance();
+
+		// Dynamic systems that are too cheap to hand off, they run on this thread after the synchronous ones
+		std::vector<System*> inlineSystems{};
+
+		for (auto system : m_Systems)
+		{
+			const auto pSystem = system.second.pSystem;
+
+			if (pSystem->GetExecutionStyle() == ExecutionStyle::ASYNCHRONOUS)
+				pThreadPool->Submit(asyncSystems, [pSystem, dt]() { pSystem->Update(dt); });
+			else if (pSystem->GetExecutionStyle() == ExecutionStyle::DYNAMIC)
+				DispatchDynamic(pSystem, dt, asyncSystems, inlineSystems);
+		}
+#else
+		std::vector<std::future<void>> futures{};
+
+		// Async system threads launched
+		for (auto system : m_Systems)
+		{
+			const auto pSystem = system.second.pSystem;
+
+			if (pSystem->GetExecutionStyle() == ExecutionStyle::ASYNCHRONOUS)
+				futures.push_back(std::async(std::launch::async, &System::Update, pSystem, dt));
+		}
+
+		// Without the engine's workers there is nothing to decide, dynamic systems run here
+		for (auto system : m_Systems)
+		{
+			if (system.second.pSystem->GetExecutionStyle() == ExecutionStyle::DYNAMIC)
+				system.second.pSystem->Update(dt);
+		}
+#endif
+
+		// Do normal updating, wave by wave, the systems inside a wave don't conflict
+		if (m_ScheduleDirty)
+			BuildSchedule();
+
+		for (const auto& wave : m_Schedule)
+		{
+#ifdef INTE
+			JobGroup waveSystems{};
+
+			for (size_t i = 1; i < wave.size(); ++i)
+			{
+				const auto pSystem = wave[i];
+				pThreadPool->Submit(waveSystems, [pSystem, dt]() { pSystem->Update(dt); });
+			}
+
+			wave[0]->Update(dt);
+			pThreadPool->Wait(waveSystems);
+#else
+			for (auto pSystem : wave)
+				pSystem->Update(dt);
+#endif
+		}
+
+		// Join the async systems
+#ifdef INTE
+		for (auto pSystem : inlineSystems)
+		{
+			auto& policy = pSystem->GetDynamicPolicy();
+			policy.Measure([pSystem, dt]() { UpdateSerial(pSystem, dt); });
+		}
+
+		Profiler::GetInstance()->BeginSubSession<SESSION_THREAD_WAITING>();
+		pThreadPool->Wait(asyncSystems);
+		Profiler::GetInstance()->EndSubSession();
+
+		// All parts are done, feed this frame's cost back in to the model
+		for (auto system : m_Systems)
+		{
+			if (system.second.pSystem->GetExecutionStyle() == ExecutionStyle::DYNAMIC)
+				system.second.pSystem->GetDynamicPolicy().EndFrame();
+		}
+#else
+		for (auto& f : futures)
+			f.get();
+#endif
+
+		// Sync point, hand out the events then apply what the systems and handlers recorded
+		for (auto pQueue : m_EventQueues)
+		{
+			if (pQueue)
+				pQueue->Dispatch(this);
+		}
+
+		FlushCommands();
+	}
+
+	void ImGuiDebug()
+	{
+#ifdef DEBUG_POOL
+		std::string str = "World: " + std::to_string(m_ID) + " system debugger";
+		ImGui::Begin(str.c_str());
+		if (ImGui::BeginTabBar("World Systems", ImGuiTabBarFlags_None))
+		{
+			if (ImGui::BeginTabItem("World stats"))
+			{
+				ImGui::Separator();
+
+				// World Id
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "World id: ");
+				ImGui::SameLine();
+				ImGui::Text(m_IsIndependent ? "%u (independent)" : "%u", m_ID);
+
+				// System count
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Entity count: ");
+				ImGui::SameLine();
+				ImGui::Text(std::to_string(m_Entities.size()).c_str());
+
+				// Entity table size, live and free slots
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Entity slots: ");
+				ImGui::SameLine();
+				ImGui::Text(std::to_string(m_Generations.size()).c_str());
+
+#ifdef INTE
+				// Throughput of the last SpawnBatch
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Last batch: ");
+				ImGui::SameLine();
+				ImGui::Text("%u entities, %.0f entities/s", m_LastBatchCount, (m_LastBatchTime > 0.f) ? static_cast<float>(m_LastBatchCount) / m_LastBatchTime : 0.f);
+
+				// Size and throughput of the last RestoreSnapshot
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Last restore: ");
+				ImGui::SameLine();
+				ImGui::Text("%.1f KB, %.0f MB/s", static_cast<float>(m_LastRestoreBytes) / 1024.f, (m_LastRestoreTime > 0.f) ? static_cast<float>(m_LastRestoreBytes) / (1024.f * 1024.f) / m_LastRestoreTime : 0.f);
+#endif
+
+				// Events handed out at the last sync point
+				size_t eventCount = 0U;
+				for (auto pQueue : m_EventQueues)
+					eventCount += (pQueue) ? pQueue->GetDeliveredCount() : 0U;
+
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Events delivered: ");
+				ImGui::SameLine();
+				ImGui::Text(std::to_string(eventCount).c_str());
+
+				// Entity count
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Component system count: ");
+				ImGui::SameLine();
+				ImGui::Text(std::to_string(m_Systems.size()).c_str());
+
+				// Cached queries and the entities they hold
+				size_t queryRowCount = 0U;
+				for (auto pQuery : m_Queries)
+					queryRowCount += pQuery->GetCount();
+
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Queries: ");
+				ImGui::SameLine();
+				ImGui::Text("%u, %u entities", static_cast<uint32_t>(m_Queries.size()), static_cast<uint32_t>(queryRowCount));
+
+				// Tag sets and the entities in them
+				size_t taggedCount = 0U;
+				for (const auto& tagSet : m_TagSets)
+					taggedCount += tagSet.second.size();
+
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Tags: ");
+				ImGui::SameLine();
+				ImGui::Text("%u, %u entities", static_cast<uint32_t>(m_TagSets.size()), static_cast<uint32_t>(taggedCount));
+
+				// Components moved by SortPools
+				ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Pool sorting: ");
+				ImGui::SameLine();
+				ImGui::Text("%u pairs, %u moved last call, %u in total", static_cast<uint32_t>(m_SortPairs.size()), m_LastSortMoveCount, m_SortMoveCount);
+
+				// Synchronous schedule
+				ImGui::Separator();
+				for (size_t i = 0; i < m_Schedule.size(); ++i)
+				{
+					ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Wave %d: ", static_cast<int>(i));
+
+					for (auto pSystem : m_Schedule[i])
+					{
+						ImGui::SameLine();
+						ImGui::Text("%s", pSystem->GetSystemTypeAsComponent().name());
+					}
+				}
+
+				// Dynamic systems, what the cost model picked last frame
+				ImGui::Separator();
+				for (auto system : m_Systems)
+				{
+					const auto pSystem = system.second.pSystem;
+
+					if (pSystem->GetExecutionStyle() != ExecutionStyle::DYNAMIC)
+						continue;
+
+					const auto& policy = pSystem->GetDynamicPolicy();
+					const char* modeNames[] = { "inline", "offload", "split" };
+
+					ImGui::TextColored(ImVec4(1.f, 1.f, 0.f, 1.f), "Dynamic: ");
+					ImGui::SameLine();
+					ImGui::Text("%s %s x%d, %.3f us per item",
+						pSystem->GetSystemTypeAsComponent().name(),
+						modeNames[static_cast<int>(policy.GetMode())],
+						static_cast<int>(policy.GetPartCount()),
+						policy.GetCostPerItem() * 1e6f);
+				}
+
+				ImGui::EndTabItem();
+			}
+#endif
+			for (auto system : m_Systems)
+				system.second.pSystem->ImGuiDebug();
+#ifdef DEBUG_POOL
+			ImGui::EndTabBar();
+		}
+		ImGui::End();
+#endif
+	}
+
+private:
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    RecordCommand
+	// FullName:  ECS::World::RecordCommand<typename F>
+	// Access:    private 
+	// Returns:   void
+	// Description: Hand the command buffer of the calling thread to record, 
+	//		threads the engine doesn't own share a locked one
+	// Parameter: F&& record
+	template<typename F>
+	void RecordCommand(F&& record)
+	{
+#ifdef INTE
+		const uint32_t threadIndex = ThreadPool::GetThreadIndex();
+
+		if (threadIndex < m_ThreadCommands.size())
+		{
+			record(m_ThreadCommands[threadIndex]);
+			return;
+		}
+#endif
+
+		std::lock_guard<std::mutex> lock(m_SharedCommandsMutex);
+		record(m_SharedCommands);
+	}
+
+	// Entity has the component of a query term, and it changed if the term asks for that
+	template<typename Q>
+	[[nodiscard]] static constexpr bool IsQueryMatch(const typename QueryTerm<Q>::Component* pC, uint32_t since)
+	{
+		if constexpr (QueryTerm<Q>::ChangedOnly)
+			return pC && pC->IsChangedSince(since);
+		else
+			return pC != nullptr;
+	}
+
+	template<typename E>
+	void PushEvent(uint32_t entityId, uint32_t tag, const E& event)
+	{
+		const uint32_t eventId = EventTypeId::Get<E>();
+
+		if (eventId < m_EventQueues.size() && m_EventQueues[eventId])
+			static_cast<EventQueue<E>*>(m_EventQueues[eventId])->Push(entityId, tag, event);
+	}
+
+	template<typename E, typename T>
+	static void DeliverEvents(World* pWorld, const std::vector<EventRecord<E>>& events);
+
+	// Query bookkeeping, an entity got a component, is about to lose one or is about to lose all of them
+	inline void OnComponentAttached(Entity* pEntity, uint32_t typeId);
+	inline void OnComponentReleasing(Entity* pEntity, uint32_t typeId);
+	inline void OnComponentsCleared(Entity* pEntity);
+
+	// Fill a query from scratch with one pass over the entities
+	inline void PopulateQuery(QueryBase* pQuery);
+
+	// Tag set bookkeeping, the entity's tag is about to change or it's about to be destroyed
+	inline void AddToTagSet(Entity* pEntity);
+	inline void RemoveFromTagSet(Entity* pEntity);
+
+	// Point everything of the entity that knew its component of the type id at pFrom to pTo
+	inline void RelocateComponent(Entity* pEntity, uint32_t typeId, const EntityComponent* pFrom, EntityComponent* pTo);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    ReserveEntities
+	// FullName:  ECS::World::ReserveEntities
+	// Access:    private 
+	// Returns:   void
+	// Description: Make room in the entity table for count more entities, 
+	//		throws before anything gets created when they wouldn't fit
+	// Parameter: uint32_t count
+	void ReserveEntities(uint32_t count)
+	{
+		const size_t fresh = (count > m_FreeIndices.size()) ? count - m_FreeIndices.size() : 0U;
+		const size_t slots = m_Generations.size() + fresh;
+
+		if (slots > ENTITY_INDEX_MASK + 1ULL)
+			throw std::exception("World is out of entity slots");
+
+		m_Generations.reserve(slots);
+		m_DensePositions.reserve(slots);
+		m_EntityPages.reserve((slots + ENTITY_PAGE_SIZE - 1U) / ENTITY_PAGE_SIZE);
+		m_Entities.reserve(m_Entities.size() + count);
+	}
+
+	template<typename T>
+	inline void PushComponentColumn(const std::vector<Entity*>& entities, EntityComponent** ppOut);
+
+	// SpawnBatch once the entities exist, throws with the batch half attached
+	template<typename... T, typename F>
+	inline void SpawnBatchComponents(const Prefab<T...>& prefab, const std::vector<Entity*>& entities, bool isArchetype, F& initializer);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    FlushCommands
+	// FullName:  ECS::World::FlushCommands
+	// Access:    private 
+	// Returns:   void
+	// Description: Merge the command buffers of all threads and apply them, main thread only.
+	//		Commands recorded while applying, by an initializer for example, wait for the next flush
+	void FlushCommands()
+	{
+		std::vector<EntityCommand> commands{};
+
+		for (auto& buffer : m_ThreadCommands)
+			buffer.MoveTo(commands);
+
+		{
+			std::lock_guard<std::mutex> lock(m_SharedCommandsMutex);
+			m_SharedCommands.MoveTo(commands);
+		}
+
+		if (commands.empty())
+			return;
+
+		std::stable_sort(commands.begin(), commands.end(), [](const EntityCommand& a, const EntityCommand& b) { return a.key < b.key; });
+
+		// Component changes, on entities that are still around
+		std::vector<uint32_t> destroyed{};
+
+		for (auto& command : commands)
+		{
+			if (command.type == CommandType::MODIFY)
+			{
+				if (auto pEntity = GetEntity(command.entity); pEntity)
+					command.func(pEntity);
+			}
+			else if (command.type == CommandType::DESTROY)
+				destroyed.push_back(command.entity);
+		}
+
+		// Destructions, by id with duplicates collapsed
+		std::sort(destroyed.begin(), destroyed.end());
+		destroyed.erase(std::unique(destroyed.begin(), destroyed.end()), destroyed.end());
+
+		for (uint32_t id : destroyed)
+			DestroyEntity(id);
+
+		// Creations
+		for (auto& command : commands)
+		{
+			if (command.type == CommandType::CREATE)
+				command.func(CreateEntity());
+			else if (command.type == CommandType::SPAWN_BATCH)
+				command.func(nullptr);
+		}
+	}
+
+#ifdef INTE
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    DispatchDynamic
+	// FullName:  ECS::World::DispatchDynamic
+	// Access:    private 
+	// Returns:   void
+	// Description: Let the system's cost model pick how it runs this frame. Offloaded and split
+	//		updates join the async group, cheap ones get queued to run inline
+	// Parameter: System * pSystem
+	// Parameter: float dt
+	// Parameter: JobGroup & group
+	// Parameter: std::vector<System*> & inlineSystems
+	void DispatchDynamic(System* pSystem, float dt, JobGroup& group, std::vector<System*>& inlineSystems)
+	{
+		const auto pThreadPool = ThreadPool::GetInstance();
+		auto& policy = pSystem->GetDynamicPolicy();
+
+		const auto mode = policy.Decide(pSystem->GetActiveCount(), pSystem->CanSplitUpdate(), pThreadPool->GetWorkerCount() + 1U);
+
+		switch (mode)
+		{
+		case DynamicMode::INLINE:
+			inlineSystems.push_back(pSystem);
+			break;
+
+		case DynamicMode::OFFLOAD:
+			pThreadPool->Submit(group, [pSystem, &policy, dt]() { policy.Measure([pSystem, dt]() { UpdateSerial(pSystem, dt); }); });
+			break;
+
+		case DynamicMode::SPLIT:
+			pThreadPool->SubmitParallelFor(group, pSystem->GetRangeCount(), policy.GetPartCount(), [pSystem, &policy, dt](uint32_t range)
+				{
+					policy.Measure([pSystem, dt, range]() { pSystem->UpdateRange(dt, range); });
+				});
+			break;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    UpdateSerial
+	// FullName:  ECS::World::UpdateSerial
+	// Access:    private 
+	// Returns:   void
+	// Description: Update a system range by range on the calling thread, dynamic systems that weren't split
+	//		shouldn't fan out on their own
+	// Parameter: System * pSystem
+	// Parameter: float dt
+	static void UpdateSerial(System* pSystem, float dt)
+	{
+		for (uint32_t range = 0U; range < pSystem->GetRangeCount(); ++range)
+			pSystem->UpdateRange(dt, range);
+	}
+#endif
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    BuildSchedule
+	// FullName:  ECS::World::BuildSchedule
+	// Access:    private 
+	// Returns:   void
+	// Description: Rebuild the waves of synchronous systems from their read/write sets
+	void BuildSchedule()
+	{
+		std::vector<System*> systems{};
+		std::vector<uint32_t> systemIds{};
+		std::vector<const SystemAccess*> accesses{};
+
+		for (const auto& system : m_Systems)
+		{
+			if (system.second.pSystem->GetExecutionStyle() != ExecutionStyle::SYNCHRONOUS)
+				continue;
+
+			systems.push_back(system.second.pSystem);
+			systemIds.push_back(system.second.systemId);
+			accesses.push_back(&system.second.pSystem->GetAccess());
+		}
+
+		m_Schedule.clear();
+		for (const auto& wave : ECS::BuildSchedule(systemIds, accesses))
+		{
+			m_Schedule.emplace_back();
+
+			for (auto index : wave)
+				m_Schedule.back().push_back(systems[index]);
+		}
+
+		m_ScheduleDirty = false;
+	}
+
+	// Entities live in pages of ENTITY_PAGE_SIZE so they never move, looked up by the index part of their id
+	static constexpr uint32_t ENTITY_PAGE_SIZE = 256U;
+
+	// First word of every snapshot, and what an entity without archetype stores as its archetype
+	static constexpr uint32_t SNAPSHOT_MAGIC = 0x534C4554U;
+	static constexpr uint32_t SNAPSHOT_NO_ARCHETYPE = ~0U;
+
+	// One live entity in a snapshot, followed by its component pointers
+	struct SnapshotEntity
+	{
+		uint64_t componentMask;
+		uint32_t id;
+		uint32_t tag;
+		uint32_t archetype;
+		uint32_t archetypeRow;
+		uint32_t componentCount;
+	};
+
+	uint32_t m_ID;
+
+	// Starts past 0 so components stamped during setup count as changed in the first update
+	uint32_t m_ChangeTick = 1U;
+	Random m_Random;
+
+	std::vector<Entity*> m_EntityPages;
+	std::vector<uint32_t> m_Generations;
+	std::vector<uint32_t> m_DensePositions;
+	std::vector<uint32_t> m_FreeIndices;
+
+#ifdef INTE
+	uint32_t m_LastBatchCount = 0U;
+	float m_LastBatchTime = 0.f;
+
+	size_t m_LastRestoreBytes = 0U;
+	float m_LastRestoreTime = 0.f;
+#endif
+
+	// Live entities, packed
+	std::vector<Entity*> m_Entities;
+	std::unordered_map<std::type_index, SystemIdentifier> m_Systems;
+	std::vector<System*> m_SystemTable;
+	std::vector<ArchetypeBase*> m_Archetypes;
+
+	std::vector<EventQueueBase*> m_EventQueues;
+
+	// Cached queries, by type for GetQuery and flat for the updates
+	std::unordered_map<std::type_index, QueryBase*> m_QueryTable;
+	std::vector<QueryBase*> m_Queries;
+
+	// Entities by tag, packed. An entity knows its position in the set of its tag
+	std::unordered_map<uint32_t, std::vector<Entity*>> m_TagSets;
+
+	// CoSortPools pairs and how far SortPools got in each
+	struct SortPair
+	{
+		System* pLeader;
+		System* pFollower;
+		uint32_t followerTypeId;
+		uint32_t cursor;
+	};
+
+	std::vector<SortPair> m_SortPairs;
+	uint32_t m_LastSortMoveCount = 0U;
+	uint32_t m_SortMoveCount = 0U;
+
+	std::vector<CommandBuffer> m_ThreadCommands;
+	CommandBuffer m_SharedCommands;
+	std::mutex m_SharedCommandsMutex;
+
+	std::vector<std::vector<System*>> m_Schedule;
+	bool m_ScheduleDirty;
+
+	bool m_IsIndependent = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+class Entity final
+{
+	// Batched spawning attaches components it constructed itself
+	friend class World;
+
+public:
 	Entity(uint32_t id, World* pWorld)
 		: m_ID(id)
+		, m_Tag(ENTITY_NO_TAG)
+		, m_TagPosition(0U)
 		, m_pWorld(pWorld)
-		, m_EntityComponents()
-		, m_Tag()
+		, m_ComponentMask(0U)
+		, m_Components()
+		, m_pArchetype(nullptr)
+		, m_ArchetypeRow(0U)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	/// Pushing components
+	//////////////////////////////////////////////////////////////////////////
+private:
+	template<typename T>
+	T* PushComponentImpl()
+	{
+		const uint32_t typeId = ComponentTypeId::Get<T>();
+
+		if (typeId >= ComponentTypeId::MAX_COUNT)
+			throw std::exception("Too many component types for the entity component mask");
+
+		// Only create a new component o type T if none other was found
+		if (m_ComponentMask & (1ULL << typeId))
+			return static_cast<T*>(m_Components[GetComponentRank(typeId)]);
+
+		auto typeIndex = std::type_index(typeid(T));
+		EntityComponent* pC = nullptr;
+
+		// Get the corresponding component world system
+		auto pCWS = m_pWorld->GetSystemByComponent<T>();
+
+		// Stored in the archetype row when the entity has one that holds T
+		if (m_pArchetype && m_pArchetype->HasColumn(typeIndex))
+		{
+			pC = new (m_pArchetype->GetSlot(typeIndex, m_ArchetypeRow)) T(this);
+			pC->SetSystem(pCWS);
+		}
+		else
+			pC = pCWS->PushComponent(this);
+
+		// Rank is taken after construction, the constructor might have pushed components of its own
+		AttachComponent(typeId, pC);
+
+		return static_cast<T*>(pC);
+	}
+
+	inline void AttachComponent(uint32_t typeId, EntityComponent* pC)
+	{
+		m_Components.insert(m_Components.begin() + GetComponentRank(typeId), pC);
+		m_ComponentMask |= (1ULL << typeId);
+		pC->MarkChanged();
+
+		m_pWorld->OnComponentAttached(this, typeId);
+	}
+
+public:
+	template<typename... T>
+	constexpr std::tuple<T* ...> PushComponents()
+	{
+		// A fresh entity whose component set matches an archetype takes a row in it
+		if (m_Components.empty() && !m_pArchetype)
+		{
+			if (auto pArchetype = m_pWorld->GetArchetype<T...>(); pArchetype)
+			{
+				m_pArchetype = pArchetype;
+				m_ArchetypeRow = pArchetype->Reserve();
+			}
+		}
+
+		return std::tuple<T * ...>(PushComponentImpl<T>()...);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	/// Popping components 
+	//////////////////////////////////////////////////////////////////////////
+private:
+	template<typename T>
+	T* PopComponentImpl()
+	{
+		const uint32_t typeId = ComponentTypeId::Get<T>();
+
+		if (typeId < ComponentTypeId::MAX_COUNT && (m_ComponentMask & (1ULL << typeId)))
+		{
+			const uint32_t rank = GetComponentRank(typeId);
+			m_pWorld->OnComponentReleasing(this, typeId);
+
+			ReleaseComponent(std::type_index(typeid(T)), m_Components[rank]);
+			m_Components.erase(m_Components.begin() + rank);
+			m_ComponentMask &= ~(1ULL << typeId);
+		}
+
+		return nullptr;
+	}
+
+public:
+	template<typename... T>
+	constexpr void PopComponents()
+	{
+		std::tuple<T* ...> t{ PopComponentImpl<T>()... };
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	/// Getting component handles
+	//////////////////////////////////////////////////////////////////////////
+public:
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    GetComponent
+	// FullName:  ECS::Entity::GetComponent<typename T>
+	// Access:    public 
+	// Returns:   T*
+	// Description: Component of type T, nullptr if the entity has none. A mask test and a pop count, no hashing
+	template<typename T>
+	[[nodiscard]] T* GetComponent()
+	{
+		const uint32_t typeId = ComponentTypeId::Get<T>();
+
+		if (typeId >= ComponentTypeId::MAX_COUNT || !(m_ComponentMask & (1ULL << typeId)))
+			return nullptr;
+
+		return static_cast<T*>(m_Components[GetComponentRank(typeId)]);
+	}
+
+	template<typename... T>
+	[[nodiscard]] constexpr std::tuple<T* ...> GetComponents()
+	{
+		return std::tuple<T * ...> { GetComponent<T>()... };
+	}
+
+	void CleanComponents()
+	{
+		m_pWorld->OnComponentsCleared(this);
+
+		// Components are stored in type id order, walk the mask to find the type of each
+		for (uint32_t typeId = 0U, rank = 0U; rank < m_Components.size(); ++typeId)
+		{
+			if (m_ComponentMask & (1ULL << typeId))
+				ReleaseComponent(ComponentTypeId::GetType(typeId), m_Components[rank++]);
+		}
+
+		m_Components.clear();
+		m_ComponentMask = 0U;
+	}
+
+private:
+	// Position of the component with the given type id in m_Components, the number of lower type ids the entity has
+	[[nodiscard]] inline uint32_t GetComponentRank(uint32_t typeId) const
+	{
+		return static_cast<uint32_t>(std::bitset<64>(m_ComponentMask & ((1ULL << typeId) - 1ULL)).count());
+	}
+
+	void ReleaseComponent(std::type_index typeIndex, EntityComponent* pComponent)
+	{
+		if (m_pArchetype && m_pArchetype->HasColumn(typeIndex))
+		{
+			// Last archetype component gone, the row was released
+			if (m_pArchetype->Pop(typeIndex, m_ArchetypeRow))
+				m_pArchetype = nullptr;
+		}
+		else
+			pComponent->GetSystem()->PopComponent(pComponent);
+	}
+
+public:
+	[[nodiscard]] inline auto GetComponentCount() const noexcept -> size_t { return m_Components.size(); }
+	[[nodiscard]] constexpr auto GetComponentMask() const noexcept -> uint64_t { return m_ComponentMask; }
+	[[nodiscard]] constexpr auto GetId() const noexcept -> uint32_t { return m_ID; }
+	[[nodiscard]] constexpr auto GetWorld() const noexcept -> World* { return m_pWorld; }
+
+	// Moves the entity to the world's set of the new tag
+	inline void SetTag(uint32_t tag);
+	[[nodiscard]] constexpr auto GetTag() const noexcept -> uint32_t { return m_Tag; }
+
+	[[nodiscard]] constexpr auto GetArchetype() const noexcept -> ArchetypeBase* { return m_pArchetype; }
+
+private:
+	const uint32_t m_ID;
+	uint32_t m_Tag;
+	uint32_t m_TagPosition; // In the world's set of m_Tag
+	World* m_pWorld;
+
+	// One bit per component type id, components are stored in type id order
+	uint64_t m_ComponentMask;
+	std::vector<EntityComponent*> m_Components;
+
+	// Archetype storage, if the entity was created with an archetype's component set
+	ArchetypeBase* m_pArchetype;
+	uint32_t m_ArchetypeRow;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Entity component change tracking declaration
+inline void EntityComponent::MarkChanged()
+{
+	if (m_pOwner)
+		m_ChangeTick = m_pOwner->GetWorld()->GetChangeTick();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Entity tag declaration
+inline void Entity::SetTag(uint32_t tag)
+{
+	if (tag == m_Tag)
+		return;
+
+	m_pWorld->RemoveFromTagSet(this);
+	m_Tag = tag;
+	m_pWorld->AddToTagSet(this);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Query declaration
+template<typename... T>
+inline void Query<T...>::Add(Entity* pEntity, uint32_t index)
+{
+	if (index >= m_Positions.size())
+		m_Positions.resize(index + 1U, NOT_MATCHED);
+
+	m_Positions[index] = static_cast<uint32_t>(m_Rows.size());
+	m_Rows.push_back(pEntity->GetComponents<T...>());
+	m_Entities.push_back(pEntity);
+	m_Indices.push_back(index);
+}
+
+template<typename... T>
+inline void Query<T...>::Refresh(Entity* pEntity, uint32_t index)
+{
+	m_Rows[m_Positions[index]] = pEntity->GetComponents<T...>();
+}
+
+template<typename... T>
+inline Query<T...>* World::GetQuery()
+{
+	const auto typeIndex = std::type_index(typeid(Query<T...>));
+
+	if (const auto it = m_QueryTable.find(typeIndex); it != m_QueryTable.end())
+		return static_cast<Query<T...>*>(it->second);
+
+	uint64_t componentMask = 0U;
+	for (const uint32_t typeId : { ComponentTypeId::Get<T>()... })
+	{
+		if (typeId >= ComponentTypeId::MAX_COUNT)
+			throw std::exception("Too many component types for the entity component mask");
+
+		componentMask |= (1ULL << typeId);
+	}
+
+	const auto pQuery = new (Memory::New<Query<T...>>()) Query<T...>(componentMask);
+	m_QueryTable[typeIndex] = pQuery;
+	m_Queries.push_back(pQuery);
+
+	PopulateQuery(pQuery);
+	return pQuery;
+}
+
+inline void World::OnComponentAttached(Entity* pEntity, uint32_t typeId)
+{
+	// Only queries asking for this type can start matching
+	for (auto pQuery : m_Queries)
+	{
+		if ((pQuery->GetComponentMask() & (1ULL << typeId)) && pQuery->IsMatch(pEntity->m_ComponentMask))
+			pQuery->Add(pEntity, pEntity->GetId() & ENTITY_INDEX_MASK);
+	}
+}
+
+inline void World::OnComponentReleasing(Entity* pEntity, uint32_t typeId)
+{
+	for (auto pQuery : m_Queries)
+	{
+		if ((pQuery->GetComponentMask() & (1ULL << typeId)) && pQuery->IsMatch(pEntity->m_ComponentMask))
+			pQuery->Remove(pEntity->GetId() & ENTITY_INDEX_MASK);
+	}
+}
+
+inline void World::OnComponentsCleared(Entity* pEntity)
+{
+	for (auto pQuery : m_Queries)
+	{
+		if (pQuery->IsMatch(pEntity->m_ComponentMask))
+			pQuery->Remove(pEntity->GetId() & ENTITY_INDEX_MASK);
+	}
+}
+
+inline void World::PopulateQuery(QueryBase* pQuery)
+{
+	pQuery->Clear();
+
+	for (auto pEntity : m_Entities)
+	{
+		if (pQuery->IsMatch(pEntity->m_ComponentMask))
+			pQuery->Add(pEntity, pEntity->GetId() & ENTITY_INDEX_MASK);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// World pool sorting declaration
+template<typename Leader, typename Follower>
+inline void World::CoSortPools()
+{
+	const auto pLeader = GetSystemByComponent<Leader>();
+	const auto pFollower = GetSystemByComponent<Follower>();
+
+	if (!pLeader || !pFollower || pLeader == pFollower)
+		throw std::exception("Co-sorted pools need two different world systems");
+
+	for (const auto& pair : m_SortPairs)
+	{
+		if (pair.pFollower == pFollower)
+			throw std::exception("A pool can only follow one other pool");
+	}
+
+	m_SortPairs.push_back({ pLeader, pFollower, ComponentTypeId::Get<Follower>(), 0U });
+}
+
+inline uint32_t World::SortPools(uint32_t slotBudget)
+{
+	uint32_t moveCount = 0U;
+
+	for (auto& pair : m_SortPairs)
+	{
+		const uint32_t slotCount = pair.pLeader->GetSlotCount();
+		const uint64_t followerBit = 1ULL << pair.followerTypeId;
+
+		for (uint32_t i = 0U; i < slotBudget && slotCount > 0U; ++i)
+		{
+			const uint32_t slot = pair.cursor % slotCount;
+			pair.cursor = slot + 1U;
+
+			const auto pLeader = pair.pLeader->GetSlotComponent(slot);
+
+			if (!pLeader)
+				continue;
+
+			const auto pEntity = pLeader->GetOwner();
+
+			if (!(pEntity->m_ComponentMask & followerBit))
+				continue;
+
+			const auto pFollower = pEntity->m_Components[pEntity->GetComponentRank(pair.followerTypeId)];
+			const uint32_t from = pair.pFollower->GetSlot(pFollower);
+
+			// In place already, in an archetype, or past the end of the follower pool
+			if (from == slot || from == POOL_NO_SLOT || slot >= pair.pFollower->GetSlotCount())
+				continue;
+
+			// Whatever sits in the slot now goes where the follower was
+			const auto pDisplaced = pair.pFollower->GetSlotComponent(slot);
+			const auto pDisplacedEntity = (pDisplaced) ? pDisplaced->GetOwner() : nullptr;
+
+			if (!pair.pFollower->SwapSlots(from, slot))
+				continue;
+
+			RelocateComponent(pEntity, pair.followerTypeId, pFollower, pair.pFollower->GetSlotComponent(slot));
+			++moveCount;
+
+			if (pDisplacedEntity)
+			{
+				RelocateComponent(pDisplacedEntity, pair.followerTypeId, pDisplaced, pair.pFollower->GetSlotComponent(from));
+				++moveCount;
+			}
+		}
+	}
+
+	m_LastSortMoveCount = moveCount;
+	m_SortMoveCount += moveCount;
+	return moveCount;
+}
+
+inline void World::RelocateComponent(Entity* pEntity, uint32_t typeId, const EntityComponent* pFrom, EntityComponent* pTo)
+{
+	pEntity->m_Components[pEntity->GetComponentRank(typeId)] = pTo;
+
+	for (auto pComponent : pEntity->m_Components)
+		pComponent->OnComponentMoved(pFrom, pTo);
+
+	for (auto pQuery : m_Queries)
+	{
+		if ((pQuery->GetComponentMask() & (1ULL << typeId)) && pQuery->IsMatch(pEntity->m_ComponentMask))
+			pQuery->Refresh(pEntity, pEntity->GetId() & ENTITY_INDEX_MASK);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// World tag set declaration
+inline const std::vector<Entity*>& World::GetTagged(uint32_t tag) const
+{
+	static const std::vector<Entity*> s_Untagged{};
+
+	const auto it = m_TagSets.find(tag);
+	return (it != m_TagSets.end()) ? it->second : s_Untagged;
+}
+
+inline void World::AddToTagSet(Entity* pEntity)
+{
+	if (pEntity->m_Tag == ENTITY_NO_TAG)
+		return;
+
+	auto& entities = m_TagSets[pEntity->m_Tag];
+	pEntity->m_TagPosition = static_cast<uint32_t>(entities.size());
+	entities.push_back(pEntity);
+}
+
+inline void World::RemoveFromTagSet(Entity* pEntity)
+{
+	if (pEntity->m_Tag == ENTITY_NO_TAG)
+		return;
+
+	// Move the last entity in to the hole
+	auto& entities = m_TagSets[pEntity->m_Tag];
+	const auto pLast = entities.back();
+
+	entities[pEntity->m_TagPosition] = pLast;
+	pLast->m_TagPosition = pEntity->m_TagPosition;
+	entities.pop_back();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// World create entity and destroy entity declaration
+inline Entity* World::CreateEntity()
+{
+	uint32_t index = 0U;
+
+	// Reuse a free slot, its generation was bumped when the previous entity got destroyed
+	if (!m_FreeIndices.empty())
 	{
+		index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
 	}
-
-	//////////////////////////////////////////////////////////////////////////
-	/// Pushing components
-	//////////////////////////////////////////////////////////////////////////
-private:
-	template<typename T>
-	T* PushComponentImpl()
+	else
 	{
-		auto typeIndex = std::type_index(typeid(T));
-		EntityComponent* pC = nullptr;
+		index = static_cast<uint32_t>(m_Generations.size());
 
-		// Only create a new component o type T if none other was found
-		if (m_EntityComponents.find(typeIndex) == m_EntityComponents.end())
-		{
-			// Get the corresponding component world system
-			auto pCWS = m_pWorld->GetSystemByComponent<T>();
+		if (index > ENTITY_INDEX_MASK)
+			throw std::exception("World is out of entity slots");
 
-			pC = pCWS->PushComponent(this);
-			m_EntityComponents[typeIndex] = pC;
+		// Pages outlive a snapshot restore that shrinks the table, they get reused when it grows again
+		if (index / ENTITY_PAGE_SIZE >= m_EntityPages.size())
+			m_EntityPages.push_back(Memory::New<Entity>(ENTITY_PAGE_SIZE));
 
-			return static_cast<T*>(pC);
-		}
+		m_Generations.push_back(0U);
+		m_DensePositions.push_back(0U);
+	}
+
+	const uint32_t id = (m_Generations[index] << ENTITY_INDEX_BITS) | index;
+	auto pEntity = new (&m_EntityPages[index / ENTITY_PAGE_SIZE][index % ENTITY_PAGE_SIZE]) Entity(id, this);
+
+	m_DensePositions[index] = static_cast<uint32_t>(m_Entities.size());
+	m_Entities.push_back(pEntity);
+
+	return pEntity;
+}
+
+inline Entity* World::GetEntity(uint32_t id) const
+{
+	const uint32_t index = id & ENTITY_INDEX_MASK;
+
+	if (index >= m_Generations.size() || m_Generations[index] != (id >> ENTITY_INDEX_BITS))
+		return nullptr;
+
+	// Generation matches, make sure the slot is actually in use
+	const auto pEntity = &m_EntityPages[index / ENTITY_PAGE_SIZE][index % ENTITY_PAGE_SIZE];
+	const uint32_t position = m_DensePositions[index];
 
-		return static_cast<T*>(m_EntityComponents[typeIndex]);
+	return (position < m_Entities.size() && m_Entities[position] == pEntity) ? pEntity : nullptr;
+}
+
+inline void World::DestroyEntity(uint32_t id)
+{
+	const auto pEntity = GetEntity(id);
+
+	// Already destroyed, or a stale id of an entity whose slot got reused
+	if (!pEntity)
+		return;
+
+	const uint32_t index = id & ENTITY_INDEX_MASK;
+	pEntity->CleanComponents();
+	RemoveFromTagSet(pEntity);
+
+	// Swap the last live entity in to the hole
+	const uint32_t position = m_DensePositions[index];
+	const auto pLast = m_Entities.back();
+
+	m_Entities[position] = pLast;
+	m_DensePositions[pLast->GetId() & ENTITY_INDEX_MASK] = position;
+	m_Entities.pop_back();
+
+	pEntity->~Entity();
+	m_Generations[index] = (m_Generations[index] + 1U) & ENTITY_GENERATION_MASK;
+	m_FreeIndices.push_back(index);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// World snapshot declaration
+inline void World::CaptureSnapshot(WorldSnapshot& snapshot) const
+{
+	snapshot.Clear();
+
+	snapshot.WriteValue(SNAPSHOT_MAGIC);
+	snapshot.WriteValue(m_ID);
+	snapshot.WriteValue(static_cast<uint32_t>(m_Systems.size()));
+	snapshot.WriteValue(static_cast<uint32_t>(m_Archetypes.size()));
+	snapshot.WriteValue(static_cast<uint32_t>(m_Generations.size()));
+	snapshot.WriteValue(m_ChangeTick);
+	snapshot.WriteValue(m_Random);
+
+	// Fixed size parts first and the entity list last, two snapshots of the same world
+	//  only shift against each other past the first entity that gained or lost a component
+
+	//////////////////////////////////////////////////////////////////////////
+	// Storage, systems in component type id order
+	for (uint32_t typeId = 0U; typeId < m_SystemTable.size(); ++typeId)
+	{
+		if (!m_SystemTable[typeId])
+			continue;
+
+		snapshot.WriteValue(typeId);
+		m_SystemTable[typeId]->SaveSnapshot(snapshot);
 	}
 
-public:
-	template<typename... T>
-	constexpr std::tuple<T* ...> PushComponents()
+	for (const auto pArchetype : m_Archetypes)
+		pArchetype->SaveSnapshot(snapshot);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Entity table, live entities in dense order with the components they point to
+	snapshot.WriteVector(m_Generations);
+	snapshot.WriteVector(m_DensePositions);
+	snapshot.WritePaddedVector(m_FreeIndices, m_Generations.size());
+	snapshot.WriteValue(static_cast<uint32_t>(m_Entities.size()));
+
+	for (const auto pEntity : m_Entities)
 	{
-		return std::tuple<T * ...>(PushComponentImpl<T>()...);
+		const auto archetype = std::find(m_Archetypes.begin(), m_Archetypes.end(), pEntity->m_pArchetype);
+
+		SnapshotEntity record{};
+		record.componentMask = pEntity->m_ComponentMask;
+		record.id = pEntity->m_ID;
+		record.tag = pEntity->m_Tag;
+		record.archetype = (archetype != m_Archetypes.end()) ? static_cast<uint32_t>(archetype - m_Archetypes.begin()) : SNAPSHOT_NO_ARCHETYPE;
+		record.archetypeRow = pEntity->m_ArchetypeRow;
+		record.componentCount = static_cast<uint32_t>(pEntity->m_Components.size());
+
+		snapshot.WriteValue(record);
+		snapshot.Write(pEntity->m_Components.data(), pEntity->m_Components.size() * sizeof(EntityComponent*));
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	/// Popping components 
+	// Query rows, their order depends on the order entities changed in and the systems iterating them rely on it
+	snapshot.WriteValue(static_cast<uint32_t>(m_Queries.size()));
+
+	for (const auto pQuery : m_Queries)
+		snapshot.WriteVector(pQuery->GetIndices());
+
 	//////////////////////////////////////////////////////////////////////////
-private:
-	template<typename T>
-	T* PopComponentImpl()
+	// Tag sets, in tag order so the same sets always come out the same
+	std::vector<uint32_t> tags{};
+	for (const auto& tagSet : m_TagSets)
 	{
-		auto typeIndex = std::type_index(typeid(T));
-		auto found = m_EntityComponents.find(typeIndex);
+		if (!tagSet.second.empty())
+			tags.push_back(tagSet.first);
+	}
+
+	std::sort(tags.begin(), tags.end());
+	snapshot.WriteValue(static_cast<uint32_t>(tags.size()));
+
+	std::vector<uint32_t> indices{};
+	for (const uint32_t tag : tags)
+	{
+		indices.clear();
+
+		for (const auto pEntity : m_TagSets.at(tag))
+			indices.push_back(pEntity->m_ID & ENTITY_INDEX_MASK);
+
+		snapshot.WriteValue(tag);
+		snapshot.WriteVector(indices);
+	}
+}
+
+inline uint32_t World::TrimPools()
+{
+	uint32_t pageCount = 0U;
+
+	for (auto system : m_Systems)
+		pageCount += system.second.pSystem->TrimPool();
+
+	return pageCount;
+}
+
+inline void World::RestoreSnapshot(const WorldSnapshot& snapshot)
+{
+#ifdef INTE
+	const auto start = std::chrono::high_resolution_clock::now();
+#endif
+
+	SnapshotReader reader(snapshot);
+
+	if (reader.ReadValue<uint32_t>() != SNAPSHOT_MAGIC || reader.ReadValue<uint32_t>() != m_ID)
+		throw std::exception("Snapshot was captured from another world");
+
+	if (reader.ReadValue<uint32_t>() != m_Systems.size() || reader.ReadValue<uint32_t>() != m_Archetypes.size())
+		throw std::exception("Snapshot doesn't match the systems and archetypes of the world");
+
+	const uint32_t slotCount = reader.ReadValue<uint32_t>();
+
+	if (slotCount > m_EntityPages.size() * ENTITY_PAGE_SIZE)
+		throw std::exception("Snapshot has more entity slots than the world, it belongs to another world");
 
-		if (found != m_EntityComponents.end())
+	const uint32_t changeTick = reader.ReadValue<uint32_t>();
+	const auto random = reader.ReadValue<Random>();
+
+	// Walk the storage once up front, a pool or archetype that can't take its part back
+	//  would otherwise throw with the world half restored
+	{
+		SnapshotReader check(snapshot);
+		check.Read(reader.GetOffset());
+
+		for (size_t i = 0U; i < m_Systems.size(); ++i)
 		{
-			// Get the corresponding component world system
-			auto pCWS = m_pWorld->GetSystemByComponent<T>();
-			pCWS->PopComponent((*found).second);
-			m_EntityComponents.erase(typeIndex);
+			const uint32_t typeId = check.ReadValue<uint32_t>();
+
+			if (typeId >= m_SystemTable.size() || !m_SystemTable[typeId])
+				throw std::exception("Snapshot doesn't match the systems and archetypes of the world");
+
+			if (!m_SystemTable[typeId]->CanRestore(check))
+				throw std::exception("Snapshot uses pool pages that have been trimmed since");
 		}
 
-		return nullptr;
+		for (const auto pArchetype : m_Archetypes)
+		{
+			if (!pArchetype->CanRestore(check))
+				throw std::exception("Snapshot has more archetype chunks than the archetype, it belongs to another world");
+		}
 	}
 
-public:
-	template<typename... T>
-	constexpr void PopComponents()
+	// Nothing was touched up to here, from now on the current state gets thrown away
+	m_ChangeTick = changeTick;
+	m_Random = random;
+
+	for (auto& buffer : m_ThreadCommands)
+		buffer.Clear();
+
 	{
-		std::tuple<T* ...> t{ PopComponentImpl<T>()... };
+		std::lock_guard<std::mutex> lock(m_SharedCommandsMutex);
+		m_SharedCommands.Clear();
+	}
+
+	for (auto pQueue : m_EventQueues)
+	{
+		if (pQueue)
+			pQueue->Clear();
 	}
 
+	// Components are replaced wholesale with their storage below, only the entities themselves go here
+	for (auto pEntity : m_Entities)
+		pEntity->~Entity();
+
+	m_Entities.clear();
+
 	//////////////////////////////////////////////////////////////////////////
-	/// Getting component handles
+	// Storage
+	for (size_t i = 0U; i < m_Systems.size(); ++i)
+	{
+		const uint32_t typeId = reader.ReadValue<uint32_t>();
+
+		if (typeId >= m_SystemTable.size() || !m_SystemTable[typeId])
+			throw std::exception("Snapshot doesn't match the systems and archetypes of the world");
+
+		m_SystemTable[typeId]->RestoreSnapshot(reader);
+	}
+
+	for (auto pArchetype : m_Archetypes)
+		pArchetype->RestoreSnapshot(reader);
+
 	//////////////////////////////////////////////////////////////////////////
-public:
-	template<typename T>
-	[[nodiscard]] T* GetComponent()
+	// Entity table
+	reader.ReadVector(m_Generations);
+	reader.ReadVector(m_DensePositions);
+	reader.ReadPaddedVector(m_FreeIndices, slotCount);
+
+	if (m_Generations.size() != slotCount)
+		throw std::exception("Snapshot is corrupt");
+
+	const uint32_t entityCount = reader.ReadValue<uint32_t>();
+	m_Entities.reserve(entityCount);
+
+	for (uint32_t i = 0U; i < entityCount; ++i)
 	{
-		auto typeIndex = std::type_index(typeid(T));
-		auto found = m_EntityComponents.find(typeIndex);
+		const auto record = reader.ReadValue<SnapshotEntity>();
+		const uint32_t index = record.id & ENTITY_INDEX_MASK;
 
-		if (found != m_EntityComponents.end())
-			return static_cast<T*>(found->second);
+		if (index >= slotCount)
+			throw std::exception("Snapshot is corrupt");
 
-		return nullptr;
+		auto pEntity = new (&m_EntityPages[index / ENTITY_PAGE_SIZE][index % ENTITY_PAGE_SIZE]) Entity(record.id, this);
+		pEntity->m_Tag = record.tag;
+		pEntity->m_ComponentMask = record.componentMask;
+		pEntity->m_pArchetype = (record.archetype != SNAPSHOT_NO_ARCHETYPE) ? m_Archetypes[record.archetype] : nullptr;
+		pEntity->m_ArchetypeRow = record.archetypeRow;
+		pEntity->m_Components.resize(record.componentCount);
+		reader.Read(pEntity->m_Components.data(), record.componentCount * sizeof(EntityComponent*));
+
+		m_Entities.push_back(pEntity);
 	}
 
-	template<typename... T>
-	[[nodiscard]] constexpr std::tuple<T* ...> GetComponents()
+	//////////////////////////////////////////////////////////////////////////
+	// Query rows, queries made after the capture are filled from scratch
+	const uint32_t queryCount = reader.ReadValue<uint32_t>();
+
+	if (queryCount > m_Queries.size())
+		throw std::exception("Snapshot doesn't match the queries of the world");
+
+	std::vector<uint32_t> indices{};
+	for (uint32_t i = 0U; i < queryCount; ++i)
 	{
-		return std::tuple<T * ...> { GetComponent<T>()... };
+		reader.ReadVector(indices);
+		m_Queries[i]->Clear();
+
+		for (const uint32_t index : indices)
+			m_Queries[i]->Add(&m_EntityPages[index / ENTITY_PAGE_SIZE][index % ENTITY_PAGE_SIZE], index);
 	}
 
-	void CleanComponents()
+	for (size_t i = queryCount; i < m_Queries.size(); ++i)
+		PopulateQuery(m_Queries[i]);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Tag sets
+	for (auto& tagSet : m_TagSets)
+		tagSet.second.clear();
+
+	const uint32_t tagCount = reader.ReadValue<uint32_t>();
+
+	for (uint32_t i = 0U; i < tagCount; ++i)
 	{
-		for (auto comp : m_EntityComponents)
+		auto& entities = m_TagSets[reader.ReadValue<uint32_t>()];
+		reader.ReadVector(indices);
+
+		for (const uint32_t index : indices)
 		{
-			auto pComponent = comp.second;
-			auto pSystem = pComponent->GetSystem();
-			pSystem->PopComponent(pComponent);
+			auto pEntity = &m_EntityPages[index / ENTITY_PAGE_SIZE][index % ENTITY_PAGE_SIZE];
+			pEntity->m_TagPosition = static_cast<uint32_t>(entities.size());
+			entities.push_back(pEntity);
 		}
-
-		m_EntityComponents.clear();
 	}
 
-public:
-	[[nodiscard]] inline auto GetComponentCount() const noexcept -> size_t { return m_EntityComponents.size(); }
-	[[nodiscard]] constexpr auto GetId() const noexcept -> uint32_t { return m_ID; }
-	[[nodiscard]] constexpr auto GetWorld() const noexcept -> World* { return m_pWorld; }
+	if (!reader.IsDone())
+		throw std::exception("Snapshot doesn't match the systems and archetypes of the world");
 
-	constexpr auto SetTag(uint32_t tag) noexcept { m_Tag = tag; }
-	[[nodiscard]] constexpr auto GetTag() const noexcept -> uint32_t { return m_Tag; }
+#ifdef INTE
+	m_LastRestoreBytes = snapshot.GetByteSize();
+	m_LastRestoreTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+#endif
+}
 
-	void Message(uint32_t message) 
-	{ 
-		std::for_each(m_EntityComponents.begin(), m_EntityComponents.end(), 
-			[message](const std::pair<std::type_index, EntityComponent*>& pC)
-			{ 
-				pC.second->OnMessage(message); 
-			}); 
+template<typename... T>
+inline void World::AsyncPushComponents(uint32_t id)
+{
+	AsyncModifyEntity(id, [](Entity* pEntity) { pEntity->PushComponents<T...>(); });
+}
+
+template<typename... T>
+inline void World::AsyncPopComponents(uint32_t id)
+{
+	AsyncModifyEntity(id, [](Entity* pEntity) { pEntity->PopComponents<T...>(); });
+}
+
+template<typename T>
+inline void World::PushComponentColumn(const std::vector<Entity*>& entities, EntityComponent** ppOut)
+{
+	const auto pSystem = GetSystemByComponent<T>();
+
+	if (!pSystem)
+		throw std::exception("No world system for a prefab component");
+
+	const uint32_t typeId = ComponentTypeId::Get<T>();
+	const auto count = static_cast<uint32_t>(entities.size());
+
+	pSystem->PushComponentBatch(entities.data(), count, ppOut);
+
+	// A constructor earlier in the prefab already pushed this one, none of the column gets attached then
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		if (entities[i]->m_ComponentMask & (1ULL << typeId))
+		{
+			for (uint32_t pushed = 0U; pushed < count; ++pushed)
+				pSystem->PopComponent(ppOut[pushed]);
+
+			throw std::exception("Prefab component got pushed twice");
+		}
 	}
 
-private:
-	const uint32_t m_ID;
-	uint32_t m_Tag;
-	World* m_pWorld;
-	std::unordered_map<std::type_index, EntityComponent*> m_EntityComponents;
-};
+	for (uint32_t i = 0U; i < count; ++i)
+		entities[i]->AttachComponent(typeId, ppOut[i]);
+}
 
-//////////////////////////////////////////////////////////////////////////
-// World create entity and destroy entity declaration
-inline Entity* World::CreateEntity()
+template<typename... T, typename F>
+inline void World::SpawnBatch(const Prefab<T...>& prefab, uint32_t count, F&& initializer)
 {
-	auto pEntity = new(Memory::New<Entity>()) Entity(m_IdCounter, this);
-	m_pEntities[m_IdCounter++] = pEntity;
+	if (count == 0U)
+		return;
 
-	return pEntity;
+#ifdef INTE
+	const auto start = std::chrono::high_resolution_clock::now();
+#endif
+
+	const bool isArchetype = GetArchetype<T...>() != nullptr;
+
+	// Pools that can't take the whole batch fail it before any entity exists
+	if (!isArchetype)
+	{
+		const System* pSystems[] = { GetSystemByComponent<T>()... };
+
+		for (const auto pSystem : pSystems)
+		{
+			if (!pSystem)
+				throw std::exception("No world system for a prefab component");
+
+			if (pSystem->GetFreeSlotCount() < count)
+				throw std::exception("Pool is full!");
+		}
+	}
+
+	ReserveEntities(count);
+
+	std::vector<Entity*> entities(count);
+	for (auto& pEntity : entities)
+		pEntity = CreateEntity();
+
+	try
+	{
+		SpawnBatchComponents(prefab, entities, isArchetype, initializer);
+	}
+	catch (...)
+	{
+		// A constructor pushed more than the pools had room for, or a prefab component twice.
+		//  The whole batch goes, components attached so far with it
+		for (auto pEntity : entities)
+			DestroyEntity(pEntity->GetId());
+
+		throw;
+	}
+
+#ifdef INTE
+	m_LastBatchCount = count;
+	m_LastBatchTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+#endif
 }
 
-inline void World::DestroyEntity(uint32_t id)
+template<typename... T, typename F>
+inline void World::SpawnBatchComponents(const Prefab<T...>& prefab, const std::vector<Entity*>& entities, bool isArchetype, F& initializer)
 {
-	auto entityIt = m_pEntities.find(id);
+	const auto count = static_cast<uint32_t>(entities.size());
 
-	if (entityIt != m_pEntities.end())
+	// Archetype rows are handed out one at a time by the archetype itself
+	if (isArchetype)
+	{
+		for (auto pEntity : entities)
+		{
+			std::apply([&](T*... pComponents)
+				{
+					prefab.ApplyDefaults(pComponents...);
+					initializer(pEntity, pComponents...);
+				}, pEntity->PushComponents<T...>());
+		}
+	}
+	else
 	{
-		auto pEntity = *entityIt;
-		pEntity.second->CleanComponents();
-		Memory::Delete(pEntity.second);
-		m_pEntities.erase(entityIt);
+		for (auto pEntity : entities)
+			pEntity->m_Components.reserve(sizeof...(T));
+
+		// Column per component type, last type first so dependencies exist when a constructor looks for them
+		using ColumnPusher = void (World::*)(const std::vector<Entity*>&, EntityComponent**);
+		constexpr ColumnPusher pushers[] = { &World::PushComponentColumn<T>... };
+
+		std::vector<EntityComponent*> components(static_cast<size_t>(count) * sizeof...(T));
+
+		for (size_t column = sizeof...(T); column > 0U; --column)
+			(this->*pushers[column - 1U])(entities, &components[(column - 1U) * count]);
+
+		for (uint32_t i = 0U; i < count; ++i)
+		{
+			prefab.ApplyDefaults(static_cast<T*>(components[ArchetypeIndexOf<T, T...>::value * count + i])...);
+			initializer(entities[i], static_cast<T*>(components[ArchetypeIndexOf<T, T...>::value * count + i])...);
+		}
 	}
 }
 
-void World::MessageAll(uint32_t message)
+//////////////////////////////////////////////////////////////////////////
+// Method:    DeliverEvents
+// FullName:  ECS::World::DeliverEvents<typename E, typename T>
+// Access:    private static 
+// Returns:   void
+// Description: Hand a frame's events to the components T they target, qualified calls 
+//		so there's no virtual hop per event. Entities that are gone by now are skipped
+// Parameter: World * pWorld
+// Parameter: const std::vector<EventRecord<E>> & events
+template<typename E, typename T>
+inline void World::DeliverEvents(World* pWorld, const std::vector<EventRecord<E>>& events)
 {
-	for (auto pe : m_pEntities)
-		pe.second->Message(message);
+	const auto pSystem = static_cast<ComponentSystem<T>*>(pWorld->GetSystemByComponent<T>());
+
+	if (!pSystem)
+		return;
+
+	for (const auto& record : events)
+	{
+		if (record.entity != EVENT_NO_ENTITY)
+		{
+			if (auto pEntity = pWorld->GetEntity(record.entity); pEntity)
+			{
+				if (auto pComponent = pEntity->template GetComponent<T>(); pComponent)
+					pComponent->T::OnEvent(record.event);
+			}
+		}
+		else if (record.tag != EVENT_ALL_TAGS)
+		{
+			// Only the entities with the tag
+			for (const auto pEntity : pWorld->GetTagged(record.tag))
+			{
+				if (auto pComponent = pEntity->template GetComponent<T>(); pComponent)
+					pComponent->T::OnEvent(record.event);
+			}
+		}
+		else
+			pSystem->ForEach([&record](T& c) { c.T::OnEvent(record.event); });
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -544,8 +2727,23 @@ inline World::~World()
 	for (auto system : m_Systems)
 		Memory::Delete(system.second.pSystem);
 
-	for (auto entity : m_pEntities)
-		Memory::Delete(entity.second);
+	for (auto pArchetype : m_Archetypes)
+		Memory::Delete(pArchetype);
+
+	for (auto pQueue : m_EventQueues)
+	{
+		if (pQueue)
+			Memory::Delete(pQueue);
+	}
+
+	for (auto pQuery : m_Queries)
+		Memory::Delete(pQuery);
+
+	for (auto pEntity : m_Entities)
+		pEntity->~Entity();
+
+	for (auto pPage : m_EntityPages)
+		Memory::Delete(pPage, false);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -553,6 +2751,9 @@ class Universe
 	: public Singleton<Universe>
 {
 public:
+	// What updates a world instead of World::Update, a Simulation stepping it at a fixed rate for example
+	using WorldUpdate = std::function<void(World*, float)>;
+
 	inline Universe()
 		: m_Worlds()
 		, m_NextWorldIndex(0U)
@@ -561,8 +2762,8 @@ public:
 
 	inline ~Universe()
 	{
-		for (auto world : m_Worlds)
-			Memory::Delete<World>(world.second);
+		for (auto& world : m_Worlds)
+			Memory::Delete<World>(world.second.pWorld);
 	}
 
 	inline World* PushWorld()
@@ -570,28 +2771,120 @@ public:
 		uint32_t id = m_NextWorldIndex++;
 
 		auto pWorld = new(Memory::New<World>()) World(id);
-		m_Worlds[id] = pWorld;
+		m_Worlds[id] = { pWorld, nullptr, 0.f, 0U };
 
 		return pWorld;
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    SetWorldUpdate
+	// FullName:  ECS::Universe::SetWorldUpdate
+	// Access:    public 
+	// Returns:   void
+	// Description: Have Update call update(pWorld, dt) for this world instead of World::Update,
+	//		nullptr goes back to World::Update
+	// Parameter: World * pWorld
+	// Parameter: const WorldUpdate & update
+	inline void SetWorldUpdate(World* pWorld, const WorldUpdate& update)
+	{
+		const auto it = m_Worlds.find(pWorld->GetId());
+
+		if (it == m_Worlds.end() || it->second.pWorld != pWorld)
+			throw std::exception("World doesn't belong to this universe");
+
+		it->second.update = update;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Method:    Update
+	// FullName:  ECS::Universe::Update
+	// Access:    public 
+	// Returns:   void
+	// Description: Update every world. Independent worlds go to the workers, the others are updated
+	//		on this thread one after the other in id order while those run, then everything is joined
+	// Parameter: float dt
 	void Update(float dt)
 	{
-		for (auto world : m_Worlds)
-			world.second->Update(dt);
+#ifdef INTE
+		const auto pThreadPool = ThreadPool::GetInstance();
+		JobGroup independentWorlds{};
+
+		for (auto& world : m_Worlds)
+		{
+			auto pEntry = &world.second;
+
+			if (pEntry->pWorld->IsIndependent())
+				pThreadPool->Submit(independentWorlds, [pEntry, dt]() { UpdateWorld(*pEntry, dt); });
+		}
+
+		// The group has to be joined before it goes out of scope, even when a world on this thread throws
+		std::exception_ptr exception{};
+
+		try
+		{
+			for (auto& world : m_Worlds)
+			{
+				if (!world.second.pWorld->IsIndependent())
+					UpdateWorld(world.second, dt);
+			}
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		pThreadPool->Wait(independentWorlds);
+
+		if (exception)
+			std::rethrow_exception(exception);
+
+		// The profiler is main thread only, report once everything is joined
+		const auto pProfiler = Profiler::GetInstance();
+
+		for (const auto& world : m_Worlds)
+			pProfiler->RecordWorld(world.first, world.second.updateTime, world.second.threadIndex);
+#else
+		for (auto& world : m_Worlds)
+			UpdateWorld(world.second, dt);
+#endif
 	}
 
 	void ImGuiDebug()
 	{
-		for (auto world : m_Worlds)
-			world.second->ImGuiDebug();
+		for (auto& world : m_Worlds)
+			world.second.pWorld->ImGuiDebug();
 	}
 
 	RO5(Universe);
 
 private:
+	struct WorldEntry
+	{
+		World* pWorld;
+		WorldUpdate update;
+
+		// Last update, how long it took and on which engine thread
+		float updateTime;
+		uint32_t threadIndex;
+	};
+
+	static void UpdateWorld(WorldEntry& entry, float dt)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		if (entry.update)
+			entry.update(entry.pWorld, dt);
+		else
+			entry.pWorld->Update(dt);
+
+		entry.updateTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+#ifdef INTE
+		entry.threadIndex = ThreadPool::GetThreadIndex();
+#endif
+	}
+
 	uint32_t m_NextWorldIndex;
-	std::map<uint32_t, World*> m_Worlds;
+	std::map<uint32_t, WorldEntry> m_Worlds;
 };
 
 };